@@ -1,26 +1,183 @@
 #include "audio.h"
 #include "synth.h"
 #include "utility.h"
+#include "kernels.h"
+#include "trace.h"
+#include <string.h>
+#include <algorithm>
 
 namespace audio {
 
+// Non-interleaved scratch buffers, one block each
+alignas(32) static float _left[BLOCK_FRAMES];
+alignas(32) static float _right[BLOCK_FRAMES];
+static float _tap[BLOCK_FRAMES];
+
+// Adapter between engine blocks and device periods of any length. Holds
+// the latest rendered block (interleaved), and how much of it was sent.
+alignas(32) static float _block[2 * BLOCK_FRAMES];
+static size_t _blockSent = BLOCK_FRAMES;
+
+// Engine output on its way into the resampler
+static constexpr size_t RESAMPLE_CHUNK_FRAMES = 4 * BLOCK_FRAMES;
+alignas(32) static float _resampleIn[2 * RESAMPLE_CHUNK_FRAMES];
+
+static double SdlClock() {
+    return (double)SDL_GetTicks();
+}
+
+static ClockFn _clock = SdlClock;
+
+// Where the current callback sits in time, for placing events
+struct CallbackTime {
+    double nowMs; // clock when the callback started
+    double lengthMs; // duration of the audio it produces
+    float sampleRateHz; // engine rate
+};
+
+// Events are applied one callback late: an event stamped anywhere during
+// the span of wall-clock time covered by the previous callback lands at
+// the same relative offset in this one. Returns the offset in engine
+// frames from the start of the callback's audio, which is past its end if
+// the event belongs to a later callback.
+static size_t EventOffset(uint32_t timestampMs, const CallbackTime& time) {
+    double sinceStartMs = (double)timestampMs - time.nowMs + time.lengthMs;
+    if (sinceStartMs <= 0.0) {
+        return 0;
+    }
+    return (size_t)(sinceStartMs * time.sampleRateHz / 1000.0);
+}
+
+static void ApplyEvent(Synth* synth, const Event& event) {
+    switch (event.type) {
+        case Event::Type::NoteOn:
+            synth->voices.NoteOn(event.note, event.value);
+            break;
+        case Event::Type::NoteOff:
+            synth->voices.NoteOff(event.note);
+            break;
+        case Event::Type::ParamChange:
+            synth->osc.SetParam(event.param, event.value, event.oscillator);
+            break;
+        case Event::Type::OscillatorSelect:
+            synth->osc.SetSource(event.index, event.oscillator);
+            break;
+        case Event::Type::EffectChange:
+            synth->effects.SetParam(event.effect, event.value);
+            break;
+        case Event::Type::PatchChange:
+            synth->patches.Apply(synth);
+            break;
+    }
+}
+
+// Render the next engine block (interleaved) into out. blockStart is where
+// its first frame lands relative to the start of the current callback, for
+// placing events.
+static void RenderBlock(Synth* synth, float* out, const CallbackTime& time, size_t blockStart) {
+    size_t pos = 0;
+    while (pos < BLOCK_FRAMES) {
+        size_t end = BLOCK_FRAMES;
+
+        // Apply events that are due, and stop rendering at the next one
+        // so it lands on its exact sample
+        while (const Event* event = synth->events.Peek()) {
+            size_t offset = EventOffset(event->timestampMs, time);
+            if (offset > blockStart + pos) {
+                end = std::min(end, offset - blockStart);
+                break;
+            }
+            ApplyEvent(synth, *event);
+            synth->events.Pop();
+        }
+
+        // The same for the song, if one is playing
+        end = pos + synth->player.Play(&synth->voices, end - pos);
+
+        size_t frames = end - pos;
+        synth->mod.Process(synth->sampleRateHz, frames);
+
+        synth->osc.Process(_left, _right, frames);
+        synth->voices.FreeIdle(); // finished releasing, stop rendering them
+        synth->effects.Process(_left, _right, frames);
+
+        // Mono copy for the scope, dropped if the UI isn't keeping up
+        for (size_t i = 0; i < frames; i++) {
+            _tap[i] = 0.5f * (_left[i] + _right[i]);
+        }
+        synth->tap.TryPush(_tap, frames);
+
+        float* blockOut = out + 2 * pos;
+        kernels::Interleave(_left, _right, blockOut, frames);
+        kernels::Gain(blockOut, blockOut, MAX_VOLUME, 2 * frames);
+        pos = end;
+    }
+}
+
+// Read frames of engine output (interleaved) into out. enginePos counts the
+// engine frames already read during this callback.
+static void ReadEngine(Synth* synth, float* out, size_t frames, const CallbackTime& time, size_t* enginePos) {
+    // Hand out what's left of the last block first, then render new ones.
+    // Whole blocks go straight to out, only a block that straddles the end
+    // is held in _block. Periods that aren't a multiple of BLOCK_FRAMES add
+    // up to BLOCK_FRAMES - 1 frames of latency.
+    size_t pos = 0;
+    while (pos < frames) {
+        if (_blockSent == BLOCK_FRAMES) {
+            if (frames - pos >= BLOCK_FRAMES) {
+                RenderBlock(synth, out + 2 * pos, time, *enginePos);
+                pos += BLOCK_FRAMES;
+                *enginePos += BLOCK_FRAMES;
+                continue;
+            }
+            RenderBlock(synth, _block, time, *enginePos);
+            _blockSent = 0;
+        }
+        size_t n = std::min(frames - pos, BLOCK_FRAMES - _blockSent);
+        memcpy(out + 2 * pos, _block + 2 * _blockSent, 2 * n * sizeof(float));
+        _blockSent += n;
+        pos += n;
+        *enginePos += n;
+    }
+}
+
 void AudioCallback(void* userdata, uint8_t* stream, int len) {
+    TRACE_THREAD("audio");
+    TRACE_ZONE("AudioCallback");
+    kernels::FlushDenormals(); // the device's thread, so every time
     Synth* synth = (Synth*)userdata;
+    Resampler& resampler = synth->resampler;
+    float* out = (float*)stream;
+    size_t frames = (size_t)len / (2 * sizeof(float));
+    synth->dspLoad.CallbackStart(frames);
 
-    while (len > 0) {
-        // TODO: loop over enabled oscillators
-        // TODO: loop over oscillator voices
-
-        float* left = (float*)(stream);
-        float* right = (float*)(stream + sizeof(float));
-        synth->osc.GetSample(left, right);
-        *left *= MAX_VOLUME;
-        *right *= MAX_VOLUME;
+    float deviceRateHz = (resampler.Active() ? resampler.OutputRateHz() : synth->sampleRateHz);
+    CallbackTime time = { _clock(), (double)frames * 1000.0 / deviceRateHz, synth->sampleRateHz };
+    size_t enginePos = 0;
 
-        // Advance forward in the stream
-        stream += (2 * sizeof(float));
-        len -= (2 * sizeof(float));
+    if (!resampler.Active()) {
+        ReadEngine(synth, out, frames, time, &enginePos);
+    } else {
+        size_t pos = 0;
+        while (pos < frames) {
+            size_t n = std::min(frames - pos, Resampler::MAX_OUTPUT_FRAMES);
+            size_t needed = resampler.InputNeeded(n);
+            while (needed > 0) {
+                size_t chunk = std::min(needed, RESAMPLE_CHUNK_FRAMES);
+                ReadEngine(synth, _resampleIn, chunk, time, &enginePos);
+                resampler.Push(_resampleIn, chunk);
+                needed -= chunk;
+            }
+            resampler.Process(out + 2 * pos, n);
+            pos += n;
+        }
     }
+
+    synth->dspLoad.CallbackEnd();
+}
+
+void SetClock(ClockFn clock) {
+    _clock = clock;
 }
 
 } // namespace audio
@@ -6,4 +6,11 @@ namespace audio {
 
 void AudioCallback(void* userdata, uint8_t* stream, int len);
 
+// Time source used to place timestamped events within a callback, in ms
+// on the same timebase as Event::timestampMs. Each callback plays the
+// events from the span of time one callback long that ends at the
+// clock's current time. Defaults to SDL_GetTicks().
+typedef double (*ClockFn)();
+void SetClock(ClockFn clock);
+
 } // namespace audio
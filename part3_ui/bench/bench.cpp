@@ -0,0 +1,657 @@
+// Microbenchmarks for the DSP hot paths.
+//
+//   synth_bench                    run all, compare against the baseline
+//   synth_bench --write-baseline   run all, store results as the baseline
+//   synth_bench <filter>           only run benchmarks whose name contains filter
+//
+// Results are in ns per sample (per frame for stereo output). Baselines are
+// machine specific, so regenerate one locally before comparing changes.
+
+#include "synth.h"
+#include "audio.h"
+#include "kernels.h"
+#include "resampler.h"
+#include "envelope.h"
+#include "effects.h"
+#include "utility.h"
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef SYNTH_BENCH_BASELINE
+#define SYNTH_BENCH_BASELINE "bench/baseline.json"
+#endif
+
+static constexpr double MIN_RUN_SEC = 0.05;
+static constexpr int NUM_RUNS = 5;
+static constexpr double REGRESSION_THRESHOLD = 0.10; // 10% slower
+static constexpr double REGRESSION_MIN_NS = 0.05; // ignore noise on tiny kernels
+static constexpr size_t BLOCK = 4096;
+
+// Written by every benchmark so the work can't be optimized away
+static volatile float _sink = 0.f;
+
+// Set when a benchmark with a fixed budget goes over it
+static bool _overBudget = false;
+
+struct Result {
+    std::string name;
+    double nsPerSample;
+};
+
+static double Now() {
+    return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+// Run fn (which processes samplesPerCall samples) repeatedly and return
+// the best ns/sample over NUM_RUNS runs
+template <typename Fn>
+static double Measure(Fn fn, size_t samplesPerCall) {
+    // Warm up caches and calibrate the number of calls per run
+    size_t calls = 1;
+    while (true) {
+        double start = Now();
+        for (size_t i = 0; i < calls; i++) {
+            fn();
+        }
+        if (Now() - start >= MIN_RUN_SEC) {
+            break;
+        }
+        calls *= 2;
+    }
+
+    double best = 1e30;
+    for (int run = 0; run < NUM_RUNS; run++) {
+        double start = Now();
+        for (size_t i = 0; i < calls; i++) {
+            fn();
+        }
+        double sec = Now() - start;
+        best = std::min(best, sec * 1e9 / (double)(calls * samplesPerCall));
+    }
+    return best;
+}
+
+class Bench {
+public:
+    explicit Bench(const char* filter) : _filter(filter) {}
+
+    template <typename Fn>
+    void Run(const std::string& name, size_t samplesPerCall, Fn fn) {
+        if (_filter && name.find(_filter) == std::string::npos) {
+            return;
+        }
+        double ns = Measure(fn, samplesPerCall);
+        results.push_back({ name, ns });
+        printf("  %-32s %10.3f ns/sample\n", name.c_str(), ns);
+        fflush(stdout);
+    }
+
+    std::vector<Result> results;
+
+private:
+    const char* _filter;
+};
+
+//-----------------------
+// Benchmarks
+//-----------------------
+
+static void BenchOscillatorFns(Bench& bench) {
+    static constexpr std::array<std::pair<const char*, oscillator::Fn>, 5> FNS = {{
+        { "Sine", oscillator::Sine },
+        { "Square", oscillator::Square },
+        { "Saw", oscillator::Saw },
+        { "Triangle", oscillator::Triangle },
+        { "Whitenoise", oscillator::Whitenoise },
+    }};
+
+    static std::array<float, BLOCK> phases;
+    for (size_t i = 0; i < BLOCK; i++) {
+        phases[i] = (float)i * TWOPI / (float)BLOCK;
+    }
+
+    for (const auto& fn : FNS) {
+        // Called through the pointer, the way the audio path used to
+        oscillator::Fn f = fn.second;
+        bench.Run(std::string("fn/") + fn.first, BLOCK, [f]() {
+            float sum = 0.f;
+            for (float phase : phases) {
+                sum += f(phase);
+            }
+            _sink = sum;
+        });
+    }
+}
+
+static void BenchUtility(Bench& bench) {
+    static std::array<float, BLOCK> values;
+    for (size_t i = 0; i < BLOCK; i++) {
+        values[i] = (float)i / (float)BLOCK * 2.f - 1.f;
+    }
+
+    bench.Run("utility/Map", BLOCK, []() {
+        float sum = 0.f;
+        for (float v : values) {
+            sum += utility::Map(v, -1.f, 1.f, 0.f, TWOPI);
+        }
+        _sink = sum;
+    });
+    bench.Run("utility/Clamp", BLOCK, []() {
+        float sum = 0.f;
+        for (float v : values) {
+            sum += utility::Clamp(v, -.5f, .5f);
+        }
+        _sink = sum;
+    });
+}
+
+static void BenchKernels(Bench& bench) {
+    static std::array<float, BLOCK> in;
+    static std::array<float, BLOCK> out;
+    static std::array<float, 2 * BLOCK> stereo;
+    static kernels::NoiseState noise;
+    noise.Seed(1);
+    for (size_t i = 0; i < BLOCK; i++) {
+        in[i] = (float)i * TWOPI / (float)BLOCK;
+    }
+
+    bench.Run("kernels/Sine", BLOCK, []() {
+        kernels::Sine(in.data(), out.data(), BLOCK);
+        _sink = out[7];
+    });
+    bench.Run("kernels/Noise", BLOCK, []() {
+        kernels::Noise(&noise, out.data(), BLOCK);
+        _sink = out[7];
+    });
+    bench.Run("kernels/Pan", BLOCK, []() {
+        kernels::Pan(in.data(), out.data(), stereo.data(), .7f, .3f, BLOCK);
+        _sink = out[7];
+    });
+    bench.Run("kernels/Interleave", BLOCK, []() {
+        kernels::Interleave(in.data(), out.data(), stereo.data(), BLOCK);
+        _sink = stereo[7];
+    });
+    bench.Run("kernels/AddRamp", BLOCK, []() {
+        kernels::AddRamp(in.data(), out.data(), .2f, .8f, BLOCK);
+        _sink = out[7];
+    });
+    bench.Run("kernels/Fir/32", BLOCK - 31, []() {
+        kernels::Fir(in.data(), 32, out.data(), stereo.data(), BLOCK - 31);
+        _sink = stereo[7];
+    });
+    bench.Run("kernels/Dot2", BLOCK, []() {
+        float a = 0.f;
+        float b = 0.f;
+        kernels::Dot2(in.data(), out.data(), stereo.data(), BLOCK, &a, &b);
+        _sink = a + b;
+    });
+    // A fifth up, as a sampler note above its root
+    bench.Run("kernels/Resample", BLOCK, []() {
+        kernels::Resample(stereo.data() + 1, 0, 3u << 17, 18, out.data(), BLOCK);
+        _sink = out[7];
+    });
+}
+
+// Per voice per sample. Voices share SIMD lanes, so the cost per voice
+// should fall as the group fills up.
+static void BenchFilters(Bench& bench) {
+    static std::array<float, kernels::FILTER_LANES * BLOCK_FRAMES> voices;
+    static kernels::SvfLanes svf;
+    static kernels::LadderLanes ladder;
+    for (size_t l = 0; l < kernels::FILTER_LANES; l++) {
+        // 1 kHz at 48 kHz, resonant
+        float g = 0.0655f;
+        float k = 0.5f;
+        svf.a1[l] = 1.f / (1.f + g * (g + k));
+        svf.a2[l] = g * svf.a1[l];
+        svf.a3[l] = g * svf.a2[l];
+        svf.m2[l] = 1.f;
+        ladder.g[l] = g / (1.f + g);
+        ladder.k[l] = 3.f;
+    }
+    for (size_t i = 0; i < voices.size(); i++) {
+        voices[i] = (float)(i % 97) / 97.f - .5f;
+    }
+
+    for (size_t lanes : { 1, 4, 8 }) {
+        std::string suffix = "/" + std::to_string(lanes) + "v";
+        bench.Run("filter/Svf" + suffix, BLOCK_FRAMES * lanes, [lanes]() {
+            kernels::Svf(&svf, voices.data(), BLOCK_FRAMES, lanes, BLOCK_FRAMES);
+            _sink = voices[7];
+        });
+        bench.Run("filter/Ladder" + suffix, BLOCK_FRAMES * lanes, [lanes]() {
+            kernels::Ladder(&ladder, voices.data(), BLOCK_FRAMES, lanes, BLOCK_FRAMES);
+            _sink = voices[7];
+        });
+    }
+}
+
+// A block split in two by an event has to end where the whole block
+// would, whatever the two lengths. Runs an attack and then a release in
+// whole blocks and in split ones, side by side.
+static bool CheckEnvelopeSplit() {
+    EnvelopeParams params;
+    params.attackMs = 2000.f; // long enough that neither ends during the check
+    params.releaseMs = 2000.f;
+    Envelope::Rates rates;
+    Envelope whole;
+    Envelope split;
+    whole.Trigger();
+    split.Trigger();
+    for (size_t block = 0; block < 200; block++) {
+        if (block == 100) {
+            whole.Release();
+            split.Release();
+        }
+        rates.Update(params, DEFAULT_SAMPLE_RATE_HZ, BLOCK_FRAMES);
+        whole.Advance(rates);
+        size_t first = 1 + block * 7 % (BLOCK_FRAMES - 1);
+        rates.Update(params, DEFAULT_SAMPLE_RATE_HZ, first);
+        split.Advance(rates);
+        rates.Update(params, DEFAULT_SAMPLE_RATE_HZ, BLOCK_FRAMES - first);
+        split.Advance(rates);
+        if (fabsf(whole.Level() - split.Level()) > 1e-4f) {
+            printf("Envelope split at %zu frames: %f, whole block: %f\n", first, split.Level(), whole.Level());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Per voice per block, the control rate part of the envelope. Envelopes
+// cycle through all their stages. The gain itself is kernels::AddRamp.
+static void BenchEnvelope(Bench& bench) {
+    static std::array<Envelope, MAX_VOICES> envelopes;
+    static Envelope::Rates rates;
+    static EnvelopeParams params;
+    params.attackMs = 10.f;
+    params.decayMs = 20.f;
+    params.sustain = .5f;
+    params.releaseMs = 30.f;
+    rates.Update(params, DEFAULT_SAMPLE_RATE_HZ, BLOCK_FRAMES);
+    for (size_t v = 0; v < envelopes.size(); v++) {
+        envelopes[v].Trigger();
+        for (size_t b = 0; b < v; b++) {
+            envelopes[v].Advance(rates); // spread them out
+        }
+    }
+
+    bench.Run("envelope/Advance", MAX_VOICES, []() {
+        rates.Update(params, DEFAULT_SAMPLE_RATE_HZ, BLOCK_FRAMES); // unchanged, only compares
+        float sum = 0.f;
+        for (Envelope& env : envelopes) {
+            sum += env.Advance(rates);
+            if (env.GetStage() == Envelope::Stage::Sustain) {
+                env.Release();
+            } else if (env.IsIdle()) {
+                env.Trigger();
+            }
+        }
+        _sink = sum;
+    });
+}
+
+static void BenchEffects(Bench& bench) {
+    static std::array<float, kernels::FDN_LINES * BLOCK_FRAMES> lines;
+    static std::array<float, BLOCK_FRAMES> input;
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+    static kernels::FdnLanes fdn;
+    for (size_t l = 0; l < kernels::FDN_LINES; l++) {
+        fdn.c[l] = .5f;
+        fdn.gain[l] = .3f;
+        fdn.inject[l] = .5f;
+    }
+    for (size_t i = 0; i < BLOCK_FRAMES; i++) {
+        input[i] = (float)(i % 97) / 97.f - .5f;
+    }
+
+    bench.Run("fx/Fdn", BLOCK_FRAMES, []() {
+        kernels::Fdn(&fdn, lines.data(), BLOCK_FRAMES, input.data(), BLOCK_FRAMES);
+        _sink = lines[7];
+    });
+
+    struct Setup {
+        const char* name;
+        bool delay;
+        bool reverb;
+    };
+    for (const Setup& setup : { Setup{ "fx/Bypassed", false, false }, Setup{ "fx/Delay", true, false },
+            Setup{ "fx/Reverb", false, true }, Setup{ "fx/Rack", true, true } }) {
+        auto effects = std::make_unique<Effects>();
+        if (!effects->Init(DEFAULT_SAMPLE_RATE_HZ)) {
+            continue;
+        }
+        effects->SetParam(Event::Effect::DelayEnabled, setup.delay ? 1.f : 0.f);
+        effects->SetParam(Event::Effect::ReverbEnabled, setup.reverb ? 1.f : 0.f);
+        Effects* e = effects.get();
+        bench.Run(setup.name, BLOCK_FRAMES, [e]() {
+            left = input;
+            right = input;
+            e->Process(left.data(), right.data(), BLOCK_FRAMES);
+            _sink = left[0];
+        });
+
+        if (!bench.results.empty() && bench.results.back().name == "fx/Rack" &&
+                bench.results.back().nsPerSample > Effects::BUDGET_NS_PER_FRAME) {
+            printf("  fx/Rack is over its budget of %.0f ns/sample\n", Effects::BUDGET_NS_PER_FRAME);
+            _overBudget = true;
+        }
+    }
+}
+
+static void BenchResampler(Bench& bench) {
+    static constexpr size_t FRAMES = 1024;
+    static std::array<float, 2 * 4 * FRAMES> in;
+    static std::array<float, 2 * FRAMES> out;
+    static Resampler resampler;
+    resampler.Init(48000.f, 44100.f);
+
+    // Per output frame, stereo
+    bench.Run("resampler/48k-44.1k", FRAMES, []() {
+        resampler.Push(in.data(), resampler.InputNeeded(FRAMES));
+        resampler.Process(out.data(), FRAMES);
+        _sink = out[7];
+    });
+}
+
+static std::unique_ptr<Synth> MakeSynth(uint32_t sourceIndex, size_t numVoices) {
+    auto synth = std::make_unique<Synth>();
+    synth->osc.Init(synth.get());
+    synth->osc.SetSource(sourceIndex);
+    for (size_t i = 0; i < numVoices; i++) {
+        synth->voices.NoteOn((uint8_t)(20 + i));
+    }
+    return synth;
+}
+
+static void BenchOscillator(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+
+    for (uint32_t source = 0; source < Oscillator::NumSources(); source++) {
+        for (size_t voices : { 1, 16, 64 }) {
+            auto synth = MakeSynth(source, voices);
+            Oscillator* osc = &synth->osc;
+            std::string name = std::string("osc/") + Oscillator::SourceName(source) + "/" + std::to_string(voices) + "v";
+
+            // One frame per call, what GetSample used to cost
+            if (voices == 1) {
+                bench.Run(name + "/1f", 1, [osc]() {
+                    osc->Process(left.data(), right.data(), 1);
+                    _sink = left[0];
+                });
+            }
+            bench.Run(name + "/" + std::to_string(BLOCK_FRAMES) + "f", BLOCK_FRAMES, [osc]() {
+                osc->Process(left.data(), right.data(), BLOCK_FRAMES);
+                _sink = left[0];
+            });
+        }
+    }
+}
+
+// The whole voice path with a filter on every voice. Compare against
+// osc/Saw/<n>v/64f.
+static void BenchOscillatorFilter(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+
+    for (size_t voices : { 16, 64 }) {
+        auto synth = MakeSynth(2, voices); // Saw
+        Oscillator* osc = &synth->osc;
+        osc->SetParam(Event::Param::FilterType, (float)filter::Type::Ladder);
+        osc->SetParam(Event::Param::FilterCutoff, 2000.f);
+        osc->SetParam(Event::Param::FilterResonance, .5f);
+        bench.Run("osc/Saw/" + std::to_string(voices) + "v/" + std::to_string(BLOCK_FRAMES) + "f/Ladder", BLOCK_FRAMES, [osc]() {
+            osc->Process(left.data(), right.data(), BLOCK_FRAMES);
+            _sink = left[0];
+        });
+    }
+}
+
+// LFO vibrato plus per-voice routes on every voice. Compare against
+// osc/Saw/<n>v/64f.
+static void BenchModulation(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+
+    for (size_t voices : { 16, 64 }) {
+        auto synth = MakeSynth(2, voices); // Saw
+        mod::Settings settings;
+        settings.routes[0] = { mod::Source::Lfo1, mod::Dest::FinePitch, .1f };
+        settings.routes[1] = { mod::Source::Velocity, mod::Dest::Volume, -.3f };
+        settings.routes[2] = { mod::Source::Key, mod::Dest::FinePitch, .05f };
+        synth->mod.Publish(settings);
+        Synth* s = synth.get();
+        bench.Run("osc/Saw/" + std::to_string(voices) + "v/" + std::to_string(BLOCK_FRAMES) + "f/Mod", BLOCK_FRAMES, [s]() {
+            s->mod.Process(s->sampleRateHz, BLOCK_FRAMES);
+            s->osc.Process(left.data(), right.data(), BLOCK_FRAMES);
+            _sink = left[0];
+        });
+    }
+}
+
+// Eight copies per call, so kernels/Unison is per frame of all eight.
+// The osc results are the whole voice path, compare against
+// osc/Saw/<n>v/64f: unison U should cost well under U times as much.
+static void BenchUnison(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+    static std::array<float, (1 << Wavetable::TABLE_BITS) + 3> table;
+    static kernels::UnisonLanes lanes;
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = sinf((float)i * TWOPI / (float)(1 << Wavetable::TABLE_BITS));
+    }
+    for (uint32_t c = 0; c < kernels::UNISON_LANES; c++) {
+        lanes.phase[c] = c * 0x9e3779b9u;
+        lanes.increment[c] = 20000000u + c * 10000u;
+        lanes.gainLeft[c] = .1f;
+        lanes.gainRight[c] = .2f;
+    }
+    bench.Run("kernels/Unison", BLOCK_FRAMES, []() {
+        kernels::Unison(&lanes, table.data() + 1, Wavetable::TABLE_BITS, true, left.data(), right.data(), BLOCK_FRAMES);
+        _sink = left[7];
+    });
+
+    for (size_t voices : { 16, 64 }) {
+        for (uint32_t unison : { 8, 16 }) {
+            auto synth = MakeSynth(2, voices); // Saw
+            Oscillator* osc = &synth->osc;
+            osc->SetParam(Event::Param::Unison, (float)unison);
+            std::string name = "osc/Saw/" + std::to_string(voices) + "v/" + std::to_string(BLOCK_FRAMES) + "f/Unison" + std::to_string(unison);
+            bench.Run(name, BLOCK_FRAMES, [osc]() {
+                osc->Process(left.data(), right.data(), BLOCK_FRAMES);
+                _sink = left[0];
+            });
+        }
+    }
+}
+
+// All three oscillators of the bank on, each summed into the voice buffer
+// as it's rendered. Compare against osc/Saw/<n>v/64f, one oscillator.
+static void BenchBank(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+
+    for (size_t voices : { 16, 64 }) {
+        auto synth = MakeSynth(2, voices); // Saw
+        Oscillator* osc = &synth->osc;
+        osc->SetParam(Event::Param::OscMix, .7f, 1);
+        osc->SetParam(Event::Param::OscFine, 7.f, 1);
+        osc->SetParam(Event::Param::OscMix, .5f, 2);
+        bench.Run("osc/Saw/" + std::to_string(voices) + "v/" + std::to_string(BLOCK_FRAMES) + "f/Bank3", BLOCK_FRAMES, [osc]() {
+            osc->Process(left.data(), right.data(), BLOCK_FRAMES);
+            _sink = left[0];
+        });
+    }
+}
+
+// Cost per voice at each oversampling factor, in ns per voice per base
+// rate frame, with drive on so the clipper runs at the oversampled rate.
+// The decimation filters are shared by all voices, so they show up most
+// in the 1 voice numbers.
+static void BenchOversampling(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+
+    for (uint32_t factor : { 1, 2, 4, 8 }) {
+        for (size_t voices : { 1, 16 }) {
+            auto synth = MakeSynth(2, voices); // Saw
+            Oscillator* osc = &synth->osc;
+            osc->SetParam(Event::Param::Oversampling, (float)factor);
+            osc->SetParam(Event::Param::Drive, .5f);
+            std::string name = "oversample/Saw/" + std::to_string(voices) + "v/" + std::to_string(factor) + "x";
+            bench.Run(name, BLOCK_FRAMES * voices, [osc]() {
+                osc->Process(left.data(), right.data(), BLOCK_FRAMES);
+                _sink = left[0];
+            });
+        }
+    }
+}
+
+// Voice rendering spread over the worker pool. Compare against the single
+// threaded osc/<source>/64v results.
+static void BenchWorkers(Bench& bench) {
+    static std::array<float, BLOCK_FRAMES> left;
+    static std::array<float, BLOCK_FRAMES> right;
+
+    auto synth = MakeSynth(2, 64); // Saw
+    if (!synth->workers.Init()) {
+        return;
+    }
+    Oscillator* osc = &synth->osc;
+    bench.Run("workers/Saw/64v/" + std::to_string(BLOCK_FRAMES) + "f", BLOCK_FRAMES, [osc]() {
+        osc->Process(left.data(), right.data(), BLOCK_FRAMES);
+        _sink = left[0];
+    });
+}
+
+static void BenchCallback(Bench& bench) {
+    static std::array<float, 2 * 1024> stream;
+    auto synth = MakeSynth(2, 8); // Saw
+    Synth* s = synth.get();
+
+    for (size_t frames : { 32, 64, 256, 1024 }) {
+        int len = (int)(2 * frames * sizeof(float));
+        bench.Run("callback/8v/" + std::to_string(frames) + "f", frames, [s, len]() {
+            audio::AudioCallback(s, (uint8_t*)stream.data(), len);
+            _sink = stream[0];
+        });
+    }
+}
+
+//-----------------------
+// Baseline
+//-----------------------
+
+// Flat JSON object of "name": ns/sample
+static std::map<std::string, double> ReadBaseline(const char* path) {
+    std::map<std::string, double> baseline;
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        return baseline;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char name[128] = {};
+        double ns = 0.0;
+        if (sscanf(line, " \"%127[^\"]\" : %lf", name, &ns) == 2) {
+            baseline[name] = ns;
+        }
+    }
+    fclose(file);
+    return baseline;
+}
+
+static bool WriteBaseline(const char* path, const std::vector<Result>& results) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "{\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        fprintf(file, "    \"%s\": %.3f%s\n",
+                results[i].name.c_str(), results[i].nsPerSample, (i + 1 < results.size() ? "," : ""));
+    }
+    fprintf(file, "}\n");
+    return (fclose(file) == 0);
+}
+
+int main(int argc, char* argv[]) {
+    bool writeBaseline = false;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--write-baseline") == 0) {
+            writeBaseline = true;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    kernels::Init();
+    kernels::FlushDenormals();
+    printf("DSP kernels: %s\n", kernels::Name());
+
+    // Correctness first, there's no point timing a wrong result
+    if (!CheckEnvelopeSplit()) {
+        return 1;
+    }
+
+    Bench bench(filter);
+    BenchOscillatorFns(bench);
+    BenchUtility(bench);
+    BenchKernels(bench);
+    BenchFilters(bench);
+    BenchEnvelope(bench);
+    BenchEffects(bench);
+    BenchResampler(bench);
+    BenchOscillator(bench);
+    BenchOscillatorFilter(bench);
+    BenchModulation(bench);
+    BenchUnison(bench);
+    BenchBank(bench);
+    BenchOversampling(bench);
+    BenchWorkers(bench);
+    BenchCallback(bench);
+
+    if (writeBaseline) {
+        if (!WriteBaseline(SYNTH_BENCH_BASELINE, bench.results)) {
+            printf("Could not write %s\n", SYNTH_BENCH_BASELINE);
+            return 1;
+        }
+        printf("Wrote %s\n", SYNTH_BENCH_BASELINE);
+        return 0;
+    }
+
+    auto baseline = ReadBaseline(SYNTH_BENCH_BASELINE);
+    if (baseline.empty()) {
+        printf("No baseline at %s, run with --write-baseline\n", SYNTH_BENCH_BASELINE);
+        return (_overBudget ? 1 : 0);
+    }
+
+    printf("\n  %-32s %10s %10s %8s\n", "vs. baseline", "now", "baseline", "change");
+    int regressions = 0;
+    for (const Result& result : bench.results) {
+        auto search = baseline.find(result.name);
+        if (search == baseline.end()) {
+            printf("  %-32s %10.3f %10s\n", result.name.c_str(), result.nsPerSample, "-");
+            continue;
+        }
+        double change = result.nsPerSample / search->second - 1.0;
+        bool regressed = (change > REGRESSION_THRESHOLD) &&
+                (result.nsPerSample - search->second > REGRESSION_MIN_NS);
+        regressions += (regressed ? 1 : 0);
+        printf("  %-32s %10.3f %10.3f %+7.1f%%%s\n",
+                result.name.c_str(), result.nsPerSample, search->second, 100.0 * change,
+                (regressed ? "  REGRESSION" : ""));
+    }
+    printf("\n%d regression(s) over %.0f%%\n", regressions, 100.0 * REGRESSION_THRESHOLD);
+    return (regressions > 0 || _overBudget ? 1 : 0);
+}
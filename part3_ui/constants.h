@@ -5,12 +5,22 @@
 
 constexpr uint32_t WINDOW_WIDTH = 1280;
 constexpr uint32_t WINDOW_HEIGHT = 720;
-constexpr float SAMPLE_RATE_HZ = 48000.f;
+constexpr float DEFAULT_SAMPLE_RATE_HZ = 48000.f; // asked of the device, the engine runs at Synth::sampleRateHz
 constexpr float MAX_VOLUME = 0.2f; // about -14 dB
+// Device period we ask for. The device may grant something else.
 #ifdef IS_WASM_BUILD
 constexpr uint16_t SAMPLES_PER_BUFFER = 256; // (256 / 48000) = 5.333 ms latency
 #else
 constexpr uint16_t SAMPLES_PER_BUFFER = 64; // (64 / 48000) = 1.333 ms latency
 #endif
 
+// The engine always renders in blocks of this many frames, whatever the
+// device period. Tune for cache/SIMD efficiency, not latency.
+constexpr uint16_t BLOCK_FRAMES = 64;
+
+constexpr uint8_t NUM_KEYS = 88; // 88-key piano
+constexpr uint8_t MAX_VOICES = 64; // max simultaneous notes
+constexpr uint32_t MAX_UNISON = 16; // detuned copies per voice
+constexpr uint32_t NUM_OSCILLATORS = 3; // per voice, OSC A to C
+
 constexpr float TWOPI = 2.0f * (float)M_PI;
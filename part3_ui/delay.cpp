@@ -0,0 +1,175 @@
+#include "delay.h"
+#include "kernels.h"
+#include "utility.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+//-----------------------
+// DelayLine
+//-----------------------
+
+bool DelayLine::Init(size_t maxDelayFrames) {
+    // One more for the interpolated read
+    size_t size = 1;
+    while (size < maxDelayFrames + 2) {
+        size *= 2;
+    }
+    _buffer.assign(size, 0.f);
+    _mask = size - 1;
+    _maxDelay = maxDelayFrames;
+    _write = 0;
+    return true;
+}
+
+void DelayLine::Clear() {
+    std::fill(_buffer.begin(), _buffer.end(), 0.f);
+}
+
+void DelayLine::Read(size_t delay, float* out, size_t n) const {
+    size_t start = (_write - delay) & _mask;
+    size_t first = std::min(n, _buffer.size() - start);
+    memcpy(out, _buffer.data() + start, first * sizeof(float));
+    memcpy(out + first, _buffer.data(), (n - first) * sizeof(float));
+}
+
+// Frame i sits back = delay - i samples before the write position, between
+// the samples k = floor(back) and k + 1 back. back > 1, so both are
+// already written.
+void DelayLine::ReadLinear(float delay0, float delay1, float* out, size_t n) const {
+    if (delay0 == delay1) {
+        // Fixed delay, the usual case: every frame has the same fraction,
+        // so blend two whole-block reads a sample apart
+        size_t k = (size_t)delay0;
+        float frac = delay0 - (float)k;
+        Read(k, out, n);
+        if (frac == 0.f) {
+            return;
+        }
+        alignas(32) float older[BLOCK_FRAMES];
+        for (size_t pos = 0; pos < n; pos += BLOCK_FRAMES) {
+            size_t m = std::min(n - pos, (size_t)BLOCK_FRAMES);
+            Read(k + 1 - pos, older, m);
+            kernels::Gain(out + pos, out + pos, 1.f - frac, m);
+            kernels::AddRamp(older, out + pos, frac, frac, m);
+        }
+        return;
+    }
+
+    float step = (delay1 - delay0) / (float)n;
+    for (size_t i = 0; i < n; i++) {
+        float back = delay0 + step * (float)(i + 1) - (float)i;
+        float k = floorf(back);
+        float frac = back - k;
+        size_t pos = _write - (size_t)k;
+        float a = _buffer[pos & _mask];
+        float b = _buffer[(pos - 1) & _mask];
+        out[i] = a + frac * (b - a);
+    }
+}
+
+void DelayLine::Write(const float* in, size_t n) {
+    size_t start = _write & _mask;
+    size_t first = std::min(n, _buffer.size() - start);
+    memcpy(_buffer.data() + start, in, first * sizeof(float));
+    memcpy(_buffer.data(), in + first, (n - first) * sizeof(float));
+    _write += n;
+}
+
+//-----------------------
+// StereoDelay
+//-----------------------
+
+const char* DelaySyncName(DelaySync sync) {
+    switch (sync) {
+        case DelaySync::Free: return "Free";
+        case DelaySync::Whole: return "1/1";
+        case DelaySync::Half: return "1/2";
+        case DelaySync::Quarter: return "1/4";
+        case DelaySync::Eighth: return "1/8";
+        case DelaySync::Sixteenth: return "1/16";
+        case DelaySync::DottedQuarter: return "1/4.";
+        case DelaySync::DottedEighth: return "1/8.";
+        case DelaySync::TripletQuarter: return "1/4T";
+        case DelaySync::TripletEighth: return "1/8T";
+    }
+    return "";
+}
+
+float DelaySyncBeats(DelaySync sync) {
+    switch (sync) {
+        case DelaySync::Free: return 0.f;
+        case DelaySync::Whole: return 4.f;
+        case DelaySync::Half: return 2.f;
+        case DelaySync::Quarter: return 1.f;
+        case DelaySync::Eighth: return 0.5f;
+        case DelaySync::Sixteenth: return 0.25f;
+        case DelaySync::DottedQuarter: return 1.5f;
+        case DelaySync::DottedEighth: return 0.75f;
+        case DelaySync::TripletQuarter: return 2.f / 3.f;
+        case DelaySync::TripletEighth: return 1.f / 3.f;
+    }
+    return 0.f;
+}
+
+bool StereoDelay::Init(float sampleRateHz) {
+    _sampleRateHz = sampleRateHz;
+    size_t maxDelay = (size_t)ceilf(MAX_TIME_MS / 1000.f * sampleRateHz);
+    for (DelayLine& line : _lines) {
+        if (!line.Init(maxDelay)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float StereoDelay::TimeMs(const DelayParams& params) {
+    float timeMs = params.timeMs;
+    if (params.sync != DelaySync::Free) {
+        float tempoBpm = utility::Clamp(params.tempoBpm, MIN_TEMPO_BPM, MAX_TEMPO_BPM);
+        timeMs = DelaySyncBeats(params.sync) * 60000.f / tempoBpm;
+    }
+    return utility::Clamp(timeMs, MIN_TIME_MS, MAX_TIME_MS);
+}
+
+void StereoDelay::Process(const DelayParams& params, float* left, float* right, size_t n) {
+    float targetFrames = TimeMs(params) / 1000.f * _sampleRateHz;
+    targetFrames = utility::Clamp(targetFrames, (float)(BLOCK_FRAMES + 1), (float)_lines[0].MaxDelay());
+
+    if (!_active) {
+        if (!params.enabled) {
+            return;
+        }
+        // Fade in from silence, with no echoes of what came before
+        for (DelayLine& line : _lines) {
+            line.Clear();
+        }
+        _active = true;
+        _delayFrames = targetFrames;
+        _mix = 0.f;
+    }
+
+    float glide = 1.f - expf(-(float)n / (GLIDE_MS / 1000.f * _sampleRateHz));
+    float delayFrames = _delayFrames + glide * (targetFrames - _delayFrames);
+    if (fabsf(targetFrames - delayFrames) < GLIDE_SNAP_FRAMES) {
+        delayFrames = targetFrames; // done gliding, see DelayLine::ReadLinear()
+    }
+    float feedback = utility::Clamp(params.feedback, 0.f, MAX_FEEDBACK);
+    float mix = (params.enabled ? utility::Clamp(params.mix, 0.f, 1.f) : 0.f);
+
+    float* channels[2] = { left, right };
+    for (size_t ch = 0; ch < 2; ch++) {
+        _lines[ch].ReadLinear(_delayFrames, delayFrames, _wet, n);
+        memcpy(_send, channels[ch], n * sizeof(float));
+        kernels::AddRamp(_wet, _send, _feedback, feedback, n);
+        _lines[ch].Write(_send, n);
+        kernels::AddRamp(_wet, channels[ch], _mix, mix, n);
+    }
+
+    _delayFrames = delayFrames;
+    _feedback = feedback;
+    _mix = mix;
+    if (!params.enabled) {
+        _active = false; // faded out this block
+    }
+}
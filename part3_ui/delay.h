@@ -0,0 +1,104 @@
+#pragma once
+
+#include "constants.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Ring buffer of past samples, a power of two long so positions wrap with
+// a mask. Allocated in Init(), reading and writing don't allocate. Each
+// block is read before it's written, so delays are at least a block long.
+class DelayLine {
+public:
+    // Holds delays up to maxDelayFrames
+    bool Init(size_t maxDelayFrames);
+
+    // Silence
+    void Clear();
+
+    // out[i] = the sample written delay frames before frame i of this
+    // block. delay must be >= n.
+    void Read(size_t delay, float* out, size_t n) const;
+
+    // The same, for a fractional delay ramped linearly from delay0 to
+    // delay1 over the block, interpolated linearly. Delays must be > n.
+    // Much cheaper when delay0 == delay1.
+    void ReadLinear(float delay0, float delay1, float* out, size_t n) const;
+
+    // Append a block
+    void Write(const float* in, size_t n);
+
+    size_t MaxDelay() const { return _maxDelay; }
+
+private:
+    std::vector<float> _buffer;
+    size_t _mask = 0;
+    size_t _maxDelay = 0;
+    size_t _write = 0; // position of the next sample written
+};
+
+// Delay times that follow the tempo, or Free for milliseconds
+enum class DelaySync : uint8_t {
+    Free,
+    Whole,
+    Half,
+    Quarter,
+    Eighth,
+    Sixteenth,
+    DottedQuarter,
+    DottedEighth,
+    TripletQuarter,
+    TripletEighth,
+};
+constexpr uint32_t NUM_DELAY_SYNCS = 10;
+
+const char* DelaySyncName(DelaySync sync);
+
+// Length in beats (quarter notes), 0 for Free
+float DelaySyncBeats(DelaySync sync);
+
+struct DelayParams {
+    bool enabled = false;
+    DelaySync sync = DelaySync::Free;
+    float timeMs = 375.f; // Free only, range [MIN_TIME_MS, MAX_TIME_MS]
+    float tempoBpm = 120.f; // synced only, range [MIN_TEMPO_BPM, MAX_TEMPO_BPM]
+    float feedback = 0.4f; // range [0, MAX_FEEDBACK]
+    float mix = 0.3f; // wet level added to the dry signal, range [0, 1]
+};
+
+// Stereo echo, each channel fed back into itself. Time changes glide like
+// a tape delay instead of jumping, so they pitch the echoes briefly rather
+// than clicking. Bypassed, it costs nothing: the wet signal fades out over
+// one block, then Process() returns straight away until it's enabled
+// again, starting from silence.
+class StereoDelay {
+public:
+    static constexpr float MIN_TIME_MS = 10.f;
+    static constexpr float MAX_TIME_MS = 2000.f; // a bar at 120 bpm
+    static constexpr float MIN_TEMPO_BPM = 40.f;
+    static constexpr float MAX_TEMPO_BPM = 240.f;
+    static constexpr float MAX_FEEDBACK = 0.95f;
+
+    bool Init(float sampleRateHz);
+
+    // n <= BLOCK_FRAMES, in place
+    void Process(const DelayParams& params, float* left, float* right, size_t n);
+
+    // Delay in ms for the settings, synced or not
+    static float TimeMs(const DelayParams& params);
+
+private:
+    static constexpr float GLIDE_MS = 60.f; // time constant of time changes
+    static constexpr float GLIDE_SNAP_FRAMES = 0.01f;
+
+    DelayLine _lines[2];
+    float _sampleRateHz = 0.f;
+
+    bool _active = false;
+    float _delayFrames = 0.f; // at the end of the last block
+    float _feedback = 0.f;
+    float _mix = 0.f;
+
+    alignas(32) float _wet[BLOCK_FRAMES];
+    alignas(32) float _send[BLOCK_FRAMES];
+};
@@ -20,9 +20,32 @@ emcc \
     -std=c++17 \
     ../main.cpp \
     ../audio.cpp \
+    ../dspload.cpp \
     ../oscillator.cpp \
+    ../param.cpp \
+    ../voice.cpp \
+    ../wavetable.cpp \
+    ../scope.cpp \
+    ../fft.cpp \
+    ../spectrum.cpp \
+    ../resampler.cpp \
+    ../oversampler.cpp \
+    ../filter.cpp \
+    ../envelope.cpp \
+    ../modmatrix.cpp \
+    ../delay.cpp \
+    ../reverb.cpp \
+    ../effects.cpp \
+    ../patch.cpp \
+    ../midifile.cpp \
+    ../sampler.cpp \
     ../sdlwrapper.cpp \
     ../ui.cpp \
     ../utility.cpp \
     ../input.cpp \
+    ../render.cpp \
+    ../trace.cpp \
+    ../wav.cpp \
+    ../kernels.cpp \
+    ../worker_pool.cpp \
     -o synth.js
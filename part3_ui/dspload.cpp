@@ -0,0 +1,65 @@
+#include "dspload.h"
+#include "constants.h"
+#include <SDL.h>
+#include <algorithm>
+
+void DspLoad::CallbackStart(size_t frames) {
+    _start = SDL_GetPerformanceCounter();
+    _deadlineTicks = (double)frames / _sampleRateHz * (double)SDL_GetPerformanceFrequency();
+
+    // Underrun: the device asked for data much later than one period
+    // after the last callback
+    if (_lastStart != 0 && (double)(_start - _lastStart) > UNDERRUN_GAP_PERIODS * _deadlineTicks) {
+        _xruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    _lastStart = _start;
+}
+
+void DspLoad::CallbackEnd() {
+    uint64_t end = SDL_GetPerformanceCounter();
+    float load = (float)((double)(end - _start) / _deadlineTicks);
+
+    // Overrun: missed the deadline
+    if (load > 1.f) {
+        _xruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    float smoothed = Load();
+    _load.store(smoothed + LOAD_SMOOTHING * (load - smoothed), std::memory_order_relaxed);
+    if (load > PeakLoad()) {
+        _peak.store(load, std::memory_order_relaxed);
+    }
+
+    size_t bin = std::min((size_t)(load / BIN_WIDTH), NUM_BINS - 1);
+    _histogram[bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+void DspLoad::ResetPeak() {
+    _peak.store(0.f, std::memory_order_relaxed);
+}
+
+void DspLoad::LogSummary() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < NUM_BINS; i++) {
+        total += Histogram(i);
+    }
+    if (total == 0) {
+        return;
+    }
+
+    SDL_Log("-------------------");
+    SDL_Log("DSP load over %llu callbacks, peak %.1f%%, xruns %u",
+            (unsigned long long)total, 100.f * PeakLoad(), Xruns());
+    for (size_t i = 0; i < NUM_BINS; i++) {
+        uint32_t count = Histogram(i);
+        if (count == 0) {
+            continue;
+        }
+        if (i == NUM_BINS - 1) {
+            SDL_Log("     >=%3d%%: %u", (int)(i * 10), count);
+        } else {
+            SDL_Log("  %3d-%3d%%: %u", (int)(i * 10), (int)((i + 1) * 10), count);
+        }
+    }
+    SDL_Log("-------------------");
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "constants.h"
+#include <atomic>
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+// Measures how much of its deadline the audio callback uses, where the
+// deadline is the duration of audio it produces (frames / sample rate).
+// The audio thread writes, any thread can read, nothing locks.
+class DspLoad {
+public:
+    static constexpr size_t NUM_BINS = 20; // 10% of the deadline per bin
+    static constexpr float BIN_WIDTH = 0.1f; // last bin is everything >= 190%
+
+    // Rate of the frames passed to CallbackStart(). Set before audio starts.
+    void SetSampleRate(float sampleRateHz) { _sampleRateHz = sampleRateHz; }
+
+    // Audio thread, bracket each callback
+    void CallbackStart(size_t frames);
+    void CallbackEnd();
+
+    // Any thread
+    float Load() const { return _load.load(std::memory_order_relaxed); } // smoothed, 1.0 = 100%
+    float PeakLoad() const { return _peak.load(std::memory_order_relaxed); }
+    uint32_t Xruns() const { return _xruns.load(std::memory_order_relaxed); }
+    uint32_t Histogram(size_t bin) const { return _histogram[bin].load(std::memory_order_relaxed); }
+    void ResetPeak();
+
+    // Log the load distribution, e.g. at exit
+    void LogSummary() const;
+
+private:
+    // One-pole smoothing of the displayed load, per callback
+    static constexpr float LOAD_SMOOTHING = 0.05f;
+
+    // A gap between callbacks longer than this many periods means the
+    // device ran dry
+    static constexpr double UNDERRUN_GAP_PERIODS = 2.5;
+
+    float _sampleRateHz = DEFAULT_SAMPLE_RATE_HZ;
+
+    // Audio thread only
+    uint64_t _start = 0;
+    uint64_t _lastStart = 0;
+    double _deadlineTicks = 0.0;
+
+    std::atomic<float> _load{0.f};
+    std::atomic<float> _peak{0.f};
+    std::atomic<uint32_t> _xruns{0};
+    std::array<std::atomic<uint32_t>, NUM_BINS> _histogram = {};
+};
@@ -0,0 +1,54 @@
+#include "effects.h"
+#include "trace.h"
+
+bool Effects::Init(float sampleRateHz) {
+    return _delay.Init(sampleRateHz) && _reverb.Init(sampleRateHz);
+}
+
+void Effects::SetParam(Event::Effect effect, float value) {
+    switch (effect) {
+        case Event::Effect::DelayEnabled:
+            _delayParams.enabled = (value != 0.f);
+            break;
+        case Event::Effect::DelaySync:
+            if (value >= 0.f && value < (float)NUM_DELAY_SYNCS) {
+                _delayParams.sync = (DelaySync)value;
+            }
+            break;
+        case Event::Effect::DelayTime:
+            _delayParams.timeMs = value;
+            break;
+        case Event::Effect::DelayFeedback:
+            _delayParams.feedback = value;
+            break;
+        case Event::Effect::DelayMix:
+            _delayParams.mix = value;
+            break;
+        case Event::Effect::Tempo:
+            _delayParams.tempoBpm = value;
+            break;
+        case Event::Effect::ReverbEnabled:
+            _reverbParams.enabled = (value != 0.f);
+            break;
+        case Event::Effect::ReverbDecay:
+            _reverbParams.decaySec = value;
+            break;
+        case Event::Effect::ReverbDamping:
+            _reverbParams.damping = value;
+            break;
+        case Event::Effect::ReverbMix:
+            _reverbParams.mix = value;
+            break;
+    }
+}
+
+void Effects::SetParams(const DelayParams& delay, const ReverbParams& reverb) {
+    _delayParams = delay;
+    _reverbParams = reverb;
+}
+
+void Effects::Process(float* left, float* right, size_t n) {
+    TRACE_ZONE("Effects::Process");
+    _delay.Process(_delayParams, left, right, n);
+    _reverb.Process(_reverbParams, left, right, n);
+}
@@ -0,0 +1,116 @@
+#include "envelope.h"
+#include "utility.h"
+#include <math.h>
+
+//-----------------------
+// Rates
+//-----------------------
+
+// A segment from `from` to `to` aims at target = to + overshoot * (to - from)
+// with a one-pole filter, and reaches `to` after timeMs. Per sample its
+// coefficient is c = 2^slope, slope = -log2((1 + overshoot) / overshoot) / timeFrames
+Envelope::Rates::Curve Envelope::Rates::MakeCurve(float from, float to, float overshoot, float timeMs, float sampleRateHz) {
+    float timeFrames = utility::Clamp(timeMs, MIN_TIME_MS, MAX_TIME_MS) / 1000.f * sampleRateHz;
+    Curve curve;
+    curve.slope = -log2f((1.f + overshoot) / overshoot) / timeFrames;
+    curve.target = to + overshoot * (to - from);
+    return curve;
+}
+
+// Over a block c^frames, and the level after a block is
+//   target + (level - target) * c^frames
+Envelope::Rates::Segment Envelope::Rates::MakeSegment(const Curve& curve, size_t frames) {
+    Segment segment;
+    segment.coeff = exp2f(curve.slope * (float)frames);
+    segment.base = curve.target * (1.f - segment.coeff);
+    return segment;
+}
+
+void Envelope::Rates::Update(const EnvelopeParams& params, float sampleRateHz, size_t frames) {
+    if (sampleRateHz != _sampleRateHz ||
+            params.attackMs != _params.attackMs || params.decayMs != _params.decayMs ||
+            params.sustain != _params.sustain || params.releaseMs != _params.releaseMs) {
+        _params = params;
+        _sampleRateHz = sampleRateHz;
+        _version++; // every cached length is stale
+
+        _sustain = utility::Clamp(params.sustain, 0.f, 1.f);
+        _attackCurve = MakeCurve(0.f, 1.f, ATTACK_OVERSHOOT, params.attackMs, sampleRateHz);
+        _decayCurve = MakeCurve(1.f, _sustain, DECAY_OVERSHOOT, params.decayMs, sampleRateHz);
+        _releaseCurve = MakeCurve(1.f, 0.f, DECAY_OVERSHOOT, params.releaseMs, sampleRateHz);
+    }
+
+    if (frames >= _lengths.size()) {
+        // Longer than a block, nothing to reuse
+        _attack = MakeSegment(_attackCurve, frames);
+        _decay = MakeSegment(_decayCurve, frames);
+        _release = MakeSegment(_releaseCurve, frames);
+        return;
+    }
+    Segments& segments = _lengths[frames];
+    if (segments.version != _version) {
+        segments.attack = MakeSegment(_attackCurve, frames);
+        segments.decay = MakeSegment(_decayCurve, frames);
+        segments.release = MakeSegment(_releaseCurve, frames);
+        segments.version = _version;
+    }
+    _attack = segments.attack;
+    _decay = segments.decay;
+    _release = segments.release;
+}
+
+//-----------------------
+// Envelope
+//-----------------------
+
+void Envelope::Trigger() {
+    _stage = Stage::Attack;
+}
+
+void Envelope::Release() {
+    if (_stage != Stage::Idle) {
+        _stage = Stage::Release;
+    }
+}
+
+void Envelope::Reset() {
+    _stage = Stage::Idle;
+    _level = 0.f;
+}
+
+float Envelope::Advance(const Rates& rates) {
+    switch (_stage) {
+        case Stage::Idle:
+            break;
+        case Stage::Attack:
+            _level = _level * rates._attack.coeff + rates._attack.base;
+            if (_level >= 1.f) {
+                _level = 1.f;
+                _stage = Stage::Decay;
+            }
+            break;
+        case Stage::Decay:
+            _level = _level * rates._decay.coeff + rates._decay.base;
+            if (_level <= rates._sustain) {
+                _level = rates._sustain;
+                _stage = Stage::Sustain;
+            }
+            break;
+        case Stage::Sustain:
+            _level = rates._sustain; // follows the knob, ramped over a block
+            break;
+        case Stage::Release:
+            _level = _level * rates._release.coeff + rates._release.base;
+            if (_level <= 0.f) {
+                _level = 0.f;
+                _stage = Stage::Idle;
+            }
+            break;
+    }
+
+    // Decayed to a sustain of 0, nothing more to hear until the next note
+    if (_stage == Stage::Sustain && _level == 0.f) {
+        _stage = Stage::Idle;
+    }
+    return _level;
+}
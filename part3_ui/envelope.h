@@ -0,0 +1,113 @@
+#pragma once
+
+#include "constants.h"
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+// ADSR settings, shared by all voices of an oscillator
+struct EnvelopeParams {
+    float attackMs = 5.f; // range [MIN_TIME_MS, MAX_TIME_MS]
+    float decayMs = 300.f;
+    float sustain = 1.f; // level, range [0, 1]
+    float releaseMs = 100.f;
+};
+
+// Per-voice ADSR amplitude envelope, advanced once per block. Each segment
+// is an exponential approach towards a target just past its end level, as
+// in an analog envelope, so it gets there in the set time instead of
+// only asymptotically. Only the level at the end of each block is
+// computed, one multiply and add per voice. The gain in between is
+// interpolated linearly by the caller (see kernels::Ramp).
+class Envelope {
+public:
+    static constexpr float MIN_TIME_MS = 1.f;
+    static constexpr float MAX_TIME_MS = 10000.f;
+
+    enum class Stage : uint8_t {
+        Idle, // silent, the voice can be freed
+        Attack,
+        Decay,
+        Sustain,
+        Release,
+    };
+
+    // Per-block steps of each segment, shared by all voices. Call Update()
+    // every block. log() only runs when the settings change, then exp2()
+    // once for each block length, so blocks split short by events reuse
+    // the steps of the last time they had that length.
+    class Rates {
+    public:
+        void Update(const EnvelopeParams& params, float sampleRateHz, size_t frames);
+
+    private:
+        friend class Envelope;
+
+        // Per sample: the level's distance to target shrinks by
+        // exp2(slope) each frame
+        struct Curve {
+            float slope = 0.f;
+            float target = 0.f;
+        };
+        static Curve MakeCurve(float from, float to, float overshoot, float timeMs, float sampleRateHz);
+
+        // Over one block: level = level * coeff + base
+        struct Segment {
+            float coeff = 0.f;
+            float base = 0.f;
+        };
+        static Segment MakeSegment(const Curve& curve, size_t frames);
+
+        // All three for one block length, current if version matches
+        struct Segments {
+            Segment attack;
+            Segment decay;
+            Segment release;
+            uint32_t version = 0;
+        };
+
+        // This block's
+        Segment _attack;
+        Segment _decay;
+        Segment _release;
+        float _sustain = 1.f;
+
+        Curve _attackCurve;
+        Curve _decayCurve;
+        Curve _releaseCurve;
+
+        // Indexed by block length, bumping _version empties it
+        std::array<Segments, BLOCK_FRAMES + 1> _lengths = {};
+        uint32_t _version = 0;
+
+        EnvelopeParams _params;
+        float _sampleRateHz = 0.f;
+    };
+
+    // Start the attack from the current level, so a retrigger doesn't click
+    void Trigger();
+
+    // Start the release, from any stage
+    void Release();
+
+    // Silent and idle
+    void Reset();
+
+    // Advance one block and return the level at its end. The level at its
+    // start is Level() before the call.
+    float Advance(const Rates& rates);
+
+    Stage GetStage() const { return _stage; }
+    bool IsIdle() const { return _stage == Stage::Idle; }
+    float Level() const { return _level; }
+
+private:
+    // How far past its end level each segment aims, relative to the
+    // distance it covers. Small is close to a pure exponential, large is
+    // close to linear.
+    static constexpr float ATTACK_OVERSHOOT = 0.3f;
+    static constexpr float DECAY_OVERSHOOT = 1e-4f; // about -80 dB
+
+    Stage _stage = Stage::Idle;
+    float _level = 0.f;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "spsc_queue.h"
+#include <stdint.h>
+
+// Message from the UI thread to the audio thread
+struct Event {
+    enum class Type : uint8_t {
+        NoteOn,
+        NoteOff,
+        ParamChange,
+        OscillatorSelect,
+        EffectChange,
+        PatchChange, // to the patch last published to Synth::patches
+    };
+
+    enum class Param : uint8_t {
+        Volume,
+        Pan,
+        CoarsePitch,
+        FinePitch,
+        Drive,
+        Oversampling, // factor, 1, 2, 4 or 8
+        FilterType, // value is a filter::Type
+        FilterCutoff, // Hz
+        FilterResonance,
+        Attack, // ms
+        Decay, // ms
+        Sustain, // level
+        Release, // ms
+        Unison, // copies per voice
+        Detune, // unison detune, [0, 1]
+        Spread, // unison stereo width, [0, 1]
+        OscMix, // level of one oscillator of the bank, [0, 1]
+        OscCoarse, // its pitch offset, semitones
+        OscFine, // cents
+    };
+
+    enum class Effect : uint8_t {
+        DelayEnabled, // 0 or 1
+        DelaySync, // value is a DelaySync
+        DelayTime, // ms, when not synced
+        DelayFeedback,
+        DelayMix,
+        Tempo, // bpm
+        ReverbEnabled, // 0 or 1
+        ReverbDecay, // seconds
+        ReverbDamping,
+        ReverbMix,
+    };
+
+    static Event NoteOn(uint32_t timestampMs, uint8_t note, float velocity = 1.f) {
+        return { Type::NoteOn, note, Param::Volume, Effect::DelayEnabled, 0, timestampMs, velocity, 0 };
+    }
+    static Event NoteOff(uint32_t timestampMs, uint8_t note) {
+        return { Type::NoteOff, note, Param::Volume, Effect::DelayEnabled, 0, timestampMs, 0.f, 0 };
+    }
+    static Event ParamChange(uint32_t timestampMs, Param param, float value, uint8_t oscillator = 0) {
+        return { Type::ParamChange, 0, param, Effect::DelayEnabled, oscillator, timestampMs, value, 0 };
+    }
+    static Event OscillatorSelect(uint32_t timestampMs, uint32_t sourceIndex, uint8_t oscillator = 0) {
+        return { Type::OscillatorSelect, 0, Param::Volume, Effect::DelayEnabled, oscillator, timestampMs, 0.f, sourceIndex };
+    }
+    static Event EffectChange(uint32_t timestampMs, Effect effect, float value) {
+        return { Type::EffectChange, 0, Param::Volume, effect, 0, timestampMs, value, 0 };
+    }
+    static Event PatchChange(uint32_t timestampMs, uint32_t patchIndex) {
+        return { Type::PatchChange, 0, Param::Volume, Effect::DelayEnabled, 0, timestampMs, 0.f, patchIndex };
+    }
+
+    Type type;
+    uint8_t note; // NoteOn, NoteOff
+    Param param; // ParamChange
+    Effect effect; // EffectChange
+    uint8_t oscillator; // of the bank, for OscillatorSelect and the Osc* params
+    uint32_t timestampMs; // SDL ticks (ms since SDL init)
+    float value; // ParamChange, EffectChange, NoteOn velocity
+    uint32_t index; // OscillatorSelect, PatchChange (for the sender, the patch itself is published)
+};
+
+using EventQueue = SpscQueue<Event, 1024>;
@@ -0,0 +1,102 @@
+#include "fft.h"
+#include "kernels.h"
+#include <SDL.h>
+#include <math.h>
+
+bool Fft::Init(size_t size) {
+    if (size < 4 || (size & (size - 1)) != 0) {
+        SDL_Log("FFT size must be a power of two >= 4, got %zu", size);
+        return false;
+    }
+    _size = size;
+    size_t n = size / 2;
+
+    size_t bits = 0;
+    while (((size_t)1 << bits) < n) {
+        bits++;
+    }
+    _bitReverse.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t reversed = 0;
+        for (size_t b = 0; b < bits; b++) {
+            reversed |= (uint32_t)((i >> b) & 1) << (bits - 1 - b);
+        }
+        _bitReverse[i] = reversed;
+    }
+
+    _twiddleRe.assign(n, 0.f);
+    _twiddleIm.assign(n, 0.f);
+    for (size_t half = 1; half < n; half *= 2) {
+        for (size_t j = 0; j < half; j++) {
+            double angle = -M_PI * (double)j / (double)half;
+            _twiddleRe[half + j] = (float)cos(angle);
+            _twiddleIm[half + j] = (float)sin(angle);
+        }
+    }
+
+    _splitRe.resize(n);
+    _splitIm.resize(n);
+    for (size_t k = 0; k < n; k++) {
+        double angle = -2.0 * M_PI * (double)k / (double)size;
+        _splitRe[k] = (float)cos(angle);
+        _splitIm[k] = (float)sin(angle);
+    }
+    return true;
+}
+
+void Fft::Forward(const float* in, float* re, float* im) const {
+    size_t n = _size / 2;
+
+    // Pack even samples as real and odd as imaginary parts, in bit-reversed
+    // order
+    for (size_t i = 0; i < n; i++) {
+        re[_bitReverse[i]] = in[2 * i];
+        im[_bitReverse[i]] = in[2 * i + 1];
+    }
+
+    // First stage has unit twiddles
+    for (size_t i = 0; i < n; i += 2) {
+        float tRe = re[i + 1];
+        float tIm = im[i + 1];
+        re[i + 1] = re[i] - tRe;
+        im[i + 1] = im[i] - tIm;
+        re[i] += tRe;
+        im[i] += tIm;
+    }
+    for (size_t half = 2; half < n; half *= 2) {
+        for (size_t start = 0; start < n; start += 2 * half) {
+            kernels::Butterfly(
+                    re + start, im + start,
+                    re + start + half, im + start + half,
+                    &_twiddleRe[half], &_twiddleIm[half],
+                    half);
+        }
+    }
+
+    // Split Z = FFT(even + i*odd) into the spectrum X of the real input:
+    //   E = (Z[k] + conj(Z[n-k])) / 2, O = -i (Z[k] - conj(Z[n-k])) / 2
+    //   X[k] = E + W^k O, X[n-k] = conj(E - W^k O)
+    float z0Re = re[0];
+    float z0Im = im[0];
+    re[0] = z0Re + z0Im;
+    im[0] = 0.f;
+    re[n] = z0Re - z0Im;
+    im[n] = 0.f;
+    for (size_t k = 1; k <= n / 2; k++) {
+        size_t m = n - k;
+        float eRe = 0.5f * (re[k] + re[m]);
+        float eIm = 0.5f * (im[k] - im[m]);
+        float oRe = 0.5f * (im[k] + im[m]);
+        float oIm = -0.5f * (re[k] - re[m]);
+        float wRe = _splitRe[k];
+        float wIm = _splitIm[k];
+        float tRe = wRe * oRe - wIm * oIm;
+        float tIm = wRe * oIm + wIm * oRe;
+        re[k] = eRe + tRe;
+        im[k] = eIm + tIm;
+        if (m != k) {
+            re[m] = eRe - tRe;
+            im[m] = -(eIm - tIm);
+        }
+    }
+}
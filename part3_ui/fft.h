@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Real-input FFT of a fixed power-of-two size. Runs as a half-size complex
+// FFT on split (separate real/imaginary) arrays so the butterflies use the
+// SIMD kernels. Tables are built in Init(), Forward() doesn't allocate.
+class Fft {
+public:
+    // size must be a power of two, at least 4
+    bool Init(size_t size);
+
+    size_t Size() const { return _size; }
+
+    // Spectrum of Size() real samples. re and im receive bins
+    // [0, Size()/2] and must hold Size()/2 + 1 values each. The transform
+    // is done in place in re and im, in is left untouched.
+    void Forward(const float* in, float* re, float* im) const;
+
+private:
+    size_t _size = 0;
+
+    // Bit-reversed index of each complex point
+    std::vector<uint32_t> _bitReverse;
+
+    // Twiddles for the butterflies spanning `half` points are at
+    // [half, 2 * half), so each stage reads them contiguously
+    std::vector<float> _twiddleRe;
+    std::vector<float> _twiddleIm;
+
+    // exp(-2 pi i k / size), for splitting the complex result into the
+    // real spectrum
+    std::vector<float> _splitRe;
+    std::vector<float> _splitIm;
+};
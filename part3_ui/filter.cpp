@@ -0,0 +1,87 @@
+#include "filter.h"
+#include "utility.h"
+#include <math.h>
+
+namespace filter {
+
+const char* TypeName(Type type) {
+    switch (type) {
+        case Type::Off: return "Off";
+        case Type::LowPass: return "LP";
+        case Type::BandPass: return "BP";
+        case Type::HighPass: return "HP";
+        case Type::Ladder: return "Ladder";
+    }
+    return "";
+}
+
+FilterGroup::FilterGroup(Type type, float sampleRateHz) :
+    _type(type),
+    _sampleRateHz(sampleRateHz) {
+    if (type == Type::Ladder) {
+        _ladder = {};
+    } else if (type != Type::Off) {
+        _svf = {};
+    }
+}
+
+void FilterGroup::Add(State* state, float cutoffHz, float resonance) {
+    if (_type == Type::Off || _numLanes == LANES) {
+        return;
+    }
+    size_t l = _numLanes++;
+    _states[l] = state;
+
+    // Prewarped, so the cutoff lands where asked up to near Nyquist
+    float fc = utility::Clamp(cutoffHz, MIN_CUTOFF_HZ, 0.45f * _sampleRateHz);
+    float g = tanf((float)M_PI * fc / _sampleRateHz);
+    resonance = utility::Clamp(resonance, 0.f, 1.f);
+
+    if (_type == Type::Ladder) {
+        _ladder.g[l] = g / (1.f + g);
+        _ladder.k[l] = 4.f * resonance;
+        _ladder.s1[l] = state->s[0];
+        _ladder.s2[l] = state->s[1];
+        _ladder.s3[l] = state->s[2];
+        _ladder.s4[l] = state->s[3];
+        return;
+    }
+
+    // k = 1 / Q, from 2 (Q = 0.5) down to 0.02 (Q = 50)
+    float k = 2.f - 1.98f * resonance;
+    float a1 = 1.f / (1.f + g * (g + k));
+    _svf.a1[l] = a1;
+    _svf.a2[l] = g * a1;
+    _svf.a3[l] = g * g * a1;
+    switch (_type) {
+        case Type::LowPass: _svf.m0[l] = 0.f; _svf.m1[l] = 0.f; _svf.m2[l] = 1.f; break;
+        case Type::BandPass: _svf.m0[l] = 0.f; _svf.m1[l] = k; _svf.m2[l] = 0.f; break; // unity gain peak
+        case Type::HighPass: _svf.m0[l] = 1.f; _svf.m1[l] = -k; _svf.m2[l] = -1.f; break;
+        default: break;
+    }
+    _svf.ic1[l] = state->s[0];
+    _svf.ic2[l] = state->s[1];
+}
+
+void FilterGroup::Process(float* voices, size_t stride, size_t frames) {
+    if (_numLanes == 0) {
+        return;
+    }
+    if (_type == Type::Ladder) {
+        kernels::Ladder(&_ladder, voices, stride, _numLanes, frames);
+        for (size_t l = 0; l < _numLanes; l++) {
+            _states[l]->s[0] = _ladder.s1[l];
+            _states[l]->s[1] = _ladder.s2[l];
+            _states[l]->s[2] = _ladder.s3[l];
+            _states[l]->s[3] = _ladder.s4[l];
+        }
+    } else {
+        kernels::Svf(&_svf, voices, stride, _numLanes, frames);
+        for (size_t l = 0; l < _numLanes; l++) {
+            _states[l]->s[0] = _svf.ic1[l];
+            _states[l]->s[1] = _svf.ic2[l];
+        }
+    }
+}
+
+} // namespace filter
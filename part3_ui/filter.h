@@ -0,0 +1,59 @@
+#pragma once
+
+#include "kernels.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Resonant per-voice filters. Voices are filtered in groups, one SIMD lane
+// per voice (see kernels::Svf and kernels::Ladder). Each voice keeps its
+// own filter state between blocks; a FilterGroup gathers it into
+// structure-of-arrays lanes for one block and scatters it back after.
+namespace filter {
+
+enum class Type : uint8_t {
+    Off,
+    LowPass, // 2-pole state variable
+    BandPass,
+    HighPass,
+    Ladder, // 4-pole lowpass
+};
+constexpr uint32_t NUM_TYPES = 5;
+
+const char* TypeName(Type type);
+
+constexpr float MIN_CUTOFF_HZ = 20.f;
+constexpr float MAX_CUTOFF_HZ = 20000.f;
+
+// Kept per voice between blocks. Large enough for any type.
+struct State {
+    float s[4] = {};
+};
+
+// Up to kernels::FILTER_LANES voices of one block. Coefficients are
+// computed once per block (control rate), per voice.
+class FilterGroup {
+public:
+    static constexpr size_t LANES = kernels::FILTER_LANES;
+
+    FilterGroup(Type type, float sampleRateHz);
+
+    // Add the next voice. resonance is in [0, 1], close to 1 rings.
+    void Add(State* state, float cutoffHz, float resonance);
+
+    // Filter the added voices in place, lane l at voices + l * stride,
+    // and store their state back
+    void Process(float* voices, size_t stride, size_t frames);
+
+private:
+    Type _type;
+    float _sampleRateHz;
+    size_t _numLanes = 0;
+    State* _states[LANES] = {};
+
+    // Unused lanes stay zero, so they compute silence. Only the one for
+    // _type is cleared.
+    kernels::SvfLanes _svf;
+    kernels::LadderLanes _ladder;
+};
+
+} // namespace filter
@@ -1,7 +1,33 @@
 #include "input.h"
 #include "synth.h"
+#include "trace.h"
+#include <array>
+
+static constexpr std::array<std::pair<SDL_Keycode, uint8_t>, 13> NOTES_MAP = {{
+    // C3 to C4
+    { SDLK_a, 39 }, { SDLK_w, 40 }, { SDLK_s, 41 }, { SDLK_e, 42 },
+    { SDLK_d, 43 }, { SDLK_f, 44 }, { SDLK_t, 45 }, { SDLK_g, 46 },
+    { SDLK_y, 47 }, { SDLK_h, 48 }, { SDLK_u, 49 }, { SDLK_j, 50 },
+    { SDLK_k, 51 },
+}};
+
+// Send a note event for a mapped key, stamped with the time of the key
+// press so the audio thread can place it on the right sample
+static void SendNoteEvent(Synth* synth, const SDL_KeyboardEvent& key, bool on) {
+    for (const auto& note : NOTES_MAP) {
+        if (note.first != key.keysym.sym) {
+            continue;
+        }
+        Event event = (on ? Event::NoteOn(key.timestamp, note.second) : Event::NoteOff(key.timestamp, note.second));
+        if (!synth->events.TryPush(event)) {
+            SDL_Log("Event queue full, dropped note event");
+        }
+        return;
+    }
+}
 
 void Input::PollEvents() {
+    TRACE_ZONE("Input::PollEvents");
     SDL_Event event;
 
     // Auto-clear per-frame data
@@ -19,9 +45,13 @@ void Input::PollEvents() {
                 SDL_Log("Escape key");
                 _synth->running = false;
             }
+            if (!event.key.repeat) {
+                SendNoteEvent(_synth, event.key, true);
+            }
             _keyIsPressed[key] = true;
         } else if (event.type == SDL_KEYUP) {
             SDL_Keycode key = event.key.keysym.sym;
+            SendNoteEvent(_synth, event.key, false);
             _keyIsPressed[key] = false;
         } else if (event.type == SDL_MOUSEBUTTONUP) {
             mouseWentUp = true;
@@ -0,0 +1,1421 @@
+#include "kernels.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace kernels {
+
+namespace {
+
+constexpr float PI = 3.14159265f;
+constexpr float HALF_PI = 1.57079633f;
+constexpr float INV_TWOPI = 0.159154943f;
+
+// 2*pi split in two so range reduction keeps precision (Cody-Waite)
+constexpr float TWOPI_HI = 6.28125f;
+constexpr float TWOPI_LO = 0.00193530717958647692f;
+
+// Taylor coefficients, good to ~6e-8 on [-pi/2, pi/2]
+constexpr float C3 = -1.66666667e-1f;
+constexpr float C5 = 8.33333333e-3f;
+constexpr float C7 = -1.98412698e-4f;
+constexpr float C9 = 2.75573192e-6f;
+constexpr float C11 = -2.50521084e-8f;
+
+constexpr size_t LANES = NoiseState::LANES;
+
+//-----------------------
+// Scalar
+//-----------------------
+
+inline float SineOne(float x) {
+    float k = rintf(x * INV_TWOPI);
+    x = (x - k * TWOPI_HI) - k * TWOPI_LO;
+
+    // Fold [-pi, pi] into [-pi/2, pi/2] with sin(pi - x) = sin(x)
+    if (x > HALF_PI) {
+        x = PI - x;
+    } else if (x < -HALF_PI) {
+        x = -PI - x;
+    }
+
+    float x2 = x * x;
+    return x * (1.f + x2 * (C3 + x2 * (C5 + x2 * (C7 + x2 * (C9 + x2 * C11)))));
+}
+
+inline uint32_t Xorshift(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Top 23 random bits as the mantissa of a float in [1, 2), then
+// remapped to [-1, 1)
+inline float BitsToUniform(uint32_t x) {
+    uint32_t bits = (x >> 9) | 0x3f800000u;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f * 2.f - 3.f;
+}
+
+// Shared by all implementations for the part that doesn't fill a vector.
+// Lane for sample i is always (i % LANES), so output doesn't depend on
+// which implementation ran.
+inline void NoiseTail(NoiseState* state, float* out, size_t start, size_t n) {
+    for (size_t i = start; i < n; i++) {
+        uint32_t& lane = state->lanes[i % LANES];
+        lane = Xorshift(lane);
+        out[i] = BitsToUniform(lane);
+    }
+}
+
+void SineScalar(const float* phase, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = SineOne(phase[i]);
+    }
+}
+
+void NoiseScalar(NoiseState* state, float* out, size_t n) {
+    NoiseTail(state, out, 0, n);
+}
+
+void GainScalar(const float* in, float* out, float gain, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = in[i] * gain;
+    }
+}
+
+void PanScalar(const float* in, float* left, float* right, float gainLeft, float gainRight, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float x = in[i];
+        left[i] = x * gainLeft;
+        right[i] = x * gainRight;
+    }
+}
+
+void InterleaveScalar(const float* left, const float* right, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[2 * i] = left[i];
+        out[2 * i + 1] = right[i];
+    }
+}
+
+void ButterflyScalar(float* aRe, float* aIm, float* bRe, float* bIm, const float* wRe, const float* wIm, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float tRe = bRe[i] * wRe[i] - bIm[i] * wIm[i];
+        float tIm = bRe[i] * wIm[i] + bIm[i] * wRe[i];
+        bRe[i] = aRe[i] - tRe;
+        bIm[i] = aIm[i] - tIm;
+        aRe[i] += tRe;
+        aIm[i] += tIm;
+    }
+}
+
+void Dot2Scalar(const float* coeffs, const float* a, const float* b, size_t n, float* outA, float* outB) {
+    float sumA = 0.f;
+    float sumB = 0.f;
+    for (size_t i = 0; i < n; i++) {
+        sumA += coeffs[i] * a[i];
+        sumB += coeffs[i] * b[i];
+    }
+    *outA = sumA;
+    *outB = sumB;
+}
+
+void FirScalar(const float* coeffs, size_t taps, const float* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float sum = 0.f;
+        for (size_t j = 0; j < taps; j++) {
+            sum += coeffs[j] * in[i + j];
+        }
+        out[i] = sum;
+    }
+}
+
+// Pade approximation of tanh, exact at 0 and reaching +-1 at +-3
+inline float SoftClipOne(float x) {
+    x = (x > 3.f ? 3.f : x);
+    x = (x < -3.f ? -3.f : x);
+    float x2 = x * x;
+    return x * (27.f + x2) / (27.f + 9.f * x2);
+}
+
+inline float SaturateOne(float x, float gain, float mix) {
+    return x + mix * (SoftClipOne(x * gain) - x);
+}
+
+void SaturateScalar(const float* in, float* out, float gain0, float gain1, float mix0, float mix1, size_t n) {
+    float gainStep = (gain1 - gain0) / (float)n;
+    float mixStep = (mix1 - mix0) / (float)n;
+    for (size_t i = 0; i < n; i++) {
+        float t = (float)(i + 1);
+        out[i] = SaturateOne(in[i], gain0 + gainStep * t, mix0 + mixStep * t);
+    }
+}
+
+void RampScalar(const float* in, float* out, float gain0, float gain1, size_t n) {
+    float step = (gain1 - gain0) / (float)n;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = in[i] * (gain0 + step * (float)(i + 1));
+    }
+}
+
+void AddRampScalar(const float* in, float* out, float gain0, float gain1, size_t n) {
+    float step = (gain1 - gain0) / (float)n;
+    for (size_t i = 0; i < n; i++) {
+        out[i] += in[i] * (gain0 + step * (float)(i + 1));
+    }
+}
+
+void SvfScalar(SvfLanes* f, float* voices, size_t stride, size_t numLanes, size_t n) {
+    for (size_t l = 0; l < numLanes; l++) {
+        float* x = voices + l * stride;
+        float a1 = f->a1[l], a2 = f->a2[l], a3 = f->a3[l];
+        float m0 = f->m0[l], m1 = f->m1[l], m2 = f->m2[l];
+        float ic1 = f->ic1[l], ic2 = f->ic2[l];
+        for (size_t i = 0; i < n; i++) {
+            float v3 = x[i] - ic2;
+            float v1 = a1 * ic1 + a2 * v3;
+            float v2 = (ic2 + a2 * ic1) + a3 * v3;
+            ic1 = (v1 + v1) - ic1;
+            ic2 = (v2 + v2) - ic2;
+            x[i] = (m0 * x[i] + m1 * v1) + m2 * v2;
+        }
+        f->ic1[l] = ic1;
+        f->ic2[l] = ic2;
+    }
+}
+
+// One trapezoidal one-pole lowpass stage of the ladder
+inline float LadderStageOne(float x, float g, float* s) {
+    float v = (x - *s) * g;
+    float y = v + *s;
+    *s = y + v;
+    return y;
+}
+
+// The ladder's output is y4 = G^4 * u + S, with S the contribution of the
+// stage states. With u = x - k * y4 that solves to
+// y4 = (G^4 * x + S) / (1 + k * G^4), giving u before any stage has run.
+void LadderScalar(LadderLanes* f, float* voices, size_t stride, size_t numLanes, size_t n) {
+    for (size_t l = 0; l < numLanes; l++) {
+        float* x = voices + l * stride;
+        float g = f->g[l], k = f->k[l];
+        float g2 = g * g, g3 = g2 * g, g4 = g3 * g;
+        float inv = 1.f / (1.f + k * g4);
+        float h = 1.f - g;
+        float s1 = f->s1[l], s2 = f->s2[l], s3 = f->s3[l], s4 = f->s4[l];
+        for (size_t i = 0; i < n; i++) {
+            float S = h * (((g3 * s1 + g2 * s2) + g * s3) + s4);
+            float y4 = (g4 * x[i] + S) * inv;
+            float u = SoftClipOne(x[i] - k * y4);
+            u = LadderStageOne(u, g, &s1);
+            u = LadderStageOne(u, g, &s2);
+            u = LadderStageOne(u, g, &s3);
+            x[i] = LadderStageOne(u, g, &s4);
+        }
+        f->s1[l] = s1;
+        f->s2[l] = s2;
+        f->s3[l] = s3;
+        f->s4[l] = s4;
+    }
+}
+
+// In place, butterflies of distance 1, 2 then 4: a, b -> a + b, a - b
+inline void HadamardScalar(float* y) {
+    for (size_t half = 1; half < FDN_LINES; half *= 2) {
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            if ((l & half) == 0) {
+                float a = y[l], b = y[l + half];
+                y[l] = a + b;
+                y[l + half] = a - b;
+            }
+        }
+    }
+}
+
+void FdnScalar(FdnLanes* f, float* lines, size_t stride, const float* in, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float y[FDN_LINES];
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            float x = lines[l * stride + i];
+            f->lp[l] = f->lp[l] + f->c[l] * (x - f->lp[l]);
+            y[l] = f->lp[l] * f->gain[l];
+        }
+        HadamardScalar(y);
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            lines[l * stride + i] = y[l] + f->inject[l] * in[i];
+        }
+    }
+}
+
+// One table lookup, the same interpolation as Wavetable::RenderLevel()
+template <bool CUBIC>
+inline float WavetableOne(const float* table, uint32_t phase, uint32_t fracBits) {
+    uint32_t index = phase >> fracBits;
+    float frac = (float)(phase & ((1u << fracBits) - 1)) * (1.f / (float)(1u << fracBits));
+    const float* y = &table[index];
+    if (!CUBIC) {
+        return y[0] + frac * (y[1] - y[0]);
+    }
+    float c1 = 0.5f * (y[1] - y[-1]);
+    float c2 = y[-1] - 2.5f * y[0] + 2.f * y[1] - 0.5f * y[2];
+    float c3 = 0.5f * (y[2] - y[-1]) + 1.5f * (y[0] - y[1]);
+    return ((c3 * frac + c2) * frac + c1) * frac + y[0];
+}
+
+// Adds frame i of every lane, in lane order
+inline void UnisonMixOne(const UnisonLanes* u, const float* copies, float* left, float* right) {
+    float l = *left, r = *right;
+    for (size_t c = 0; c < UNISON_LANES; c++) {
+        l += u->gainLeft[c] * copies[c];
+        r += u->gainRight[c] * copies[c];
+    }
+    *left = l;
+    *right = r;
+}
+
+template <bool CUBIC>
+void UnisonScalar(UnisonLanes* u, const float* table, uint32_t tableBits, float* left, float* right, size_t n) {
+    uint32_t fracBits = 32 - tableBits;
+    for (size_t i = 0; i < n; i++) {
+        float copies[UNISON_LANES];
+        for (size_t c = 0; c < UNISON_LANES; c++) {
+            copies[c] = WavetableOne<CUBIC>(table, u->phase[c], fracBits);
+            u->phase[c] += u->increment[c];
+        }
+        UnisonMixOne(u, copies, &left[i], &right[i]);
+    }
+}
+
+void UnisonScalar(UnisonLanes* u, const float* table, uint32_t tableBits, bool cubic, float* left, float* right, size_t n) {
+    if (cubic) {
+        UnisonScalar<true>(u, table, tableBits, left, right, n);
+    } else {
+        UnisonScalar<false>(u, table, tableBits, left, right, n);
+    }
+}
+
+void ResampleScalar(const float* in, uint32_t position, uint32_t increment, uint32_t fracBits, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = WavetableOne<true>(in, position, fracBits);
+        position += increment;
+    }
+}
+
+#ifdef KERNELS_X86
+
+//-----------------------
+// SSE2
+//-----------------------
+
+inline __m128 SineSse2(__m128 x) {
+    const __m128 signMask = _mm_set1_ps(-0.f);
+    __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(INV_TWOPI))));
+    x = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(TWOPI_HI))), _mm_mul_ps(k, _mm_set1_ps(TWOPI_LO)));
+
+    __m128 sign = _mm_and_ps(x, signMask);
+    __m128 absX = _mm_andnot_ps(signMask, x);
+    __m128 fold = _mm_cmpgt_ps(absX, _mm_set1_ps(HALF_PI));
+    __m128 folded = _mm_sub_ps(_mm_or_ps(_mm_set1_ps(PI), sign), x);
+    x = _mm_or_ps(_mm_and_ps(fold, folded), _mm_andnot_ps(fold, x));
+
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(C11);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C9));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C7));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C5));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(C3));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.f));
+    return _mm_mul_ps(p, x);
+}
+
+inline __m128i XorshiftSse2(__m128i x) {
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    return x;
+}
+
+inline __m128 BitsToUniformSse2(__m128i x) {
+    __m128i bits = _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3f800000));
+    return _mm_sub_ps(_mm_mul_ps(_mm_castsi128_ps(bits), _mm_set1_ps(2.f)), _mm_set1_ps(3.f));
+}
+
+void SineSse2(const float* phase, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, SineSse2(_mm_loadu_ps(phase + i)));
+    }
+    for (; i < n; i++) {
+        out[i] = SineOne(phase[i]);
+    }
+}
+
+void NoiseSse2(NoiseState* state, float* out, size_t n) {
+    __m128i lo = _mm_loadu_si128((const __m128i*)&state->lanes[0]);
+    __m128i hi = _mm_loadu_si128((const __m128i*)&state->lanes[4]);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        lo = XorshiftSse2(lo);
+        hi = XorshiftSse2(hi);
+        _mm_storeu_ps(out + i, BitsToUniformSse2(lo));
+        _mm_storeu_ps(out + i + 4, BitsToUniformSse2(hi));
+    }
+    _mm_storeu_si128((__m128i*)&state->lanes[0], lo);
+    _mm_storeu_si128((__m128i*)&state->lanes[4], hi);
+    NoiseTail(state, out, i, n);
+}
+
+void GainSse2(const float* in, float* out, float gain, size_t n) {
+    __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), g));
+    }
+    for (; i < n; i++) {
+        out[i] = in[i] * gain;
+    }
+}
+
+void PanSse2(const float* in, float* left, float* right, float gainLeft, float gainRight, size_t n) {
+    __m128 gl = _mm_set1_ps(gainLeft);
+    __m128 gr = _mm_set1_ps(gainRight);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(in + i);
+        _mm_storeu_ps(left + i, _mm_mul_ps(x, gl));
+        _mm_storeu_ps(right + i, _mm_mul_ps(x, gr));
+    }
+    PanScalar(in + i, left + i, right + i, gainLeft, gainRight, n - i);
+}
+
+void InterleaveSse2(const float* left, const float* right, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+    InterleaveScalar(left + i, right + i, out + 2 * i, n - i);
+}
+
+void ButterflySse2(float* aRe, float* aIm, float* bRe, float* bIm, const float* wRe, const float* wIm, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 br = _mm_loadu_ps(bRe + i);
+        __m128 bi = _mm_loadu_ps(bIm + i);
+        __m128 wr = _mm_loadu_ps(wRe + i);
+        __m128 wi = _mm_loadu_ps(wIm + i);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+        __m128 ar = _mm_loadu_ps(aRe + i);
+        __m128 ai = _mm_loadu_ps(aIm + i);
+        _mm_storeu_ps(bRe + i, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(bIm + i, _mm_sub_ps(ai, ti));
+        _mm_storeu_ps(aRe + i, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(aIm + i, _mm_add_ps(ai, ti));
+    }
+    ButterflyScalar(aRe + i, aIm + i, bRe + i, bIm + i, wRe + i, wIm + i, n - i);
+}
+
+inline float HorizontalSumSse2(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+void Dot2Sse2(const float* coeffs, const float* a, const float* b, size_t n, float* outA, float* outB) {
+    __m128 sumA = _mm_setzero_ps();
+    __m128 sumB = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 c = _mm_loadu_ps(coeffs + i);
+        sumA = _mm_add_ps(sumA, _mm_mul_ps(c, _mm_loadu_ps(a + i)));
+        sumB = _mm_add_ps(sumB, _mm_mul_ps(c, _mm_loadu_ps(b + i)));
+    }
+    float tailA = 0.f;
+    float tailB = 0.f;
+    Dot2Scalar(coeffs + i, a + i, b + i, n - i, &tailA, &tailB);
+    *outA = HorizontalSumSse2(sumA) + tailA;
+    *outB = HorizontalSumSse2(sumB) + tailB;
+}
+
+// Outputs are computed 8 at a time in two accumulators, each coefficient
+// broadcast once and applied to shifted loads of the input
+void FirSse2(const float* coeffs, size_t taps, const float* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        for (size_t j = 0; j < taps; j++) {
+            __m128 c = _mm_set1_ps(coeffs[j]);
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(c, _mm_loadu_ps(in + i + j)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(c, _mm_loadu_ps(in + i + j + 4)));
+        }
+        _mm_storeu_ps(out + i, sum0);
+        _mm_storeu_ps(out + i + 4, sum1);
+    }
+    FirScalar(coeffs, taps, in + i, out + i, n - i);
+}
+
+// Same operations in the same order as the scalar version, so the output
+// matches it exactly
+void SaturateSse2(const float* in, float* out, float gain0, float gain1, float mix0, float mix1, size_t n) {
+    float gainStep = (gain1 - gain0) / (float)n;
+    float mixStep = (mix1 - mix0) / (float)n;
+    __m128 g0 = _mm_set1_ps(gain0);
+    __m128 gs = _mm_set1_ps(gainStep);
+    __m128 m0 = _mm_set1_ps(mix0);
+    __m128 ms = _mm_set1_ps(mixStep);
+    __m128 lo = _mm_set1_ps(-3.f);
+    __m128 hi = _mm_set1_ps(3.f);
+    __m128 c27 = _mm_set1_ps(27.f);
+    __m128 c9 = _mm_set1_ps(9.f);
+    __m128 t = _mm_setr_ps(1.f, 2.f, 3.f, 4.f);
+    __m128 four = _mm_set1_ps(4.f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(in + i);
+        __m128 mix = _mm_add_ps(m0, _mm_mul_ps(ms, t));
+        __m128 y = _mm_mul_ps(x, _mm_add_ps(g0, _mm_mul_ps(gs, t)));
+        y = _mm_max_ps(_mm_min_ps(y, hi), lo);
+        __m128 y2 = _mm_mul_ps(y, y);
+        __m128 wet = _mm_div_ps(_mm_mul_ps(y, _mm_add_ps(c27, y2)), _mm_add_ps(c27, _mm_mul_ps(c9, y2)));
+        _mm_storeu_ps(out + i, _mm_add_ps(x, _mm_mul_ps(mix, _mm_sub_ps(wet, x))));
+        t = _mm_add_ps(t, four);
+    }
+    for (; i < n; i++) {
+        float ti = (float)(i + 1);
+        out[i] = SaturateOne(in[i], gain0 + gainStep * ti, mix0 + mixStep * ti);
+    }
+}
+
+template <bool ADD>
+void RampSse2(const float* in, float* out, float gain0, float gain1, size_t n) {
+    float step = (gain1 - gain0) / (float)n;
+    __m128 g0 = _mm_set1_ps(gain0);
+    __m128 gs = _mm_set1_ps(step);
+    __m128 t = _mm_setr_ps(1.f, 2.f, 3.f, 4.f);
+    __m128 four = _mm_set1_ps(4.f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 y = _mm_mul_ps(_mm_loadu_ps(in + i), _mm_add_ps(g0, _mm_mul_ps(gs, t)));
+        if (ADD) {
+            y = _mm_add_ps(_mm_loadu_ps(out + i), y);
+        }
+        _mm_storeu_ps(out + i, y);
+        t = _mm_add_ps(t, four);
+    }
+    for (; i < n; i++) {
+        float y = in[i] * (gain0 + step * (float)(i + 1));
+        out[i] = (ADD ? out[i] + y : y);
+    }
+}
+
+inline __m128 SoftClipSse2(__m128 x) {
+    x = _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(3.f)), _mm_set1_ps(-3.f));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 c27 = _mm_set1_ps(27.f);
+    return _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(c27, x2)), _mm_add_ps(c27, _mm_mul_ps(_mm_set1_ps(9.f), x2)));
+}
+
+// Filters for 4 lanes starting at lane0, same operations in the same
+// order as the scalar versions
+
+struct SvfStepSse2 {
+    __m128 a1, a2, a3, m0, m1, m2, ic1, ic2;
+
+    SvfStepSse2(const SvfLanes* f, size_t lane0) :
+        a1(_mm_load_ps(f->a1 + lane0)), a2(_mm_load_ps(f->a2 + lane0)), a3(_mm_load_ps(f->a3 + lane0)),
+        m0(_mm_load_ps(f->m0 + lane0)), m1(_mm_load_ps(f->m1 + lane0)), m2(_mm_load_ps(f->m2 + lane0)),
+        ic1(_mm_load_ps(f->ic1 + lane0)), ic2(_mm_load_ps(f->ic2 + lane0)) {}
+
+    __m128 Step(__m128 x) {
+        __m128 v3 = _mm_sub_ps(x, ic2);
+        __m128 v1 = _mm_add_ps(_mm_mul_ps(a1, ic1), _mm_mul_ps(a2, v3));
+        __m128 v2 = _mm_add_ps(_mm_add_ps(ic2, _mm_mul_ps(a2, ic1)), _mm_mul_ps(a3, v3));
+        ic1 = _mm_sub_ps(_mm_add_ps(v1, v1), ic1);
+        ic2 = _mm_sub_ps(_mm_add_ps(v2, v2), ic2);
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, v1)), _mm_mul_ps(m2, v2));
+    }
+
+    void Store(SvfLanes* f, size_t lane0) {
+        _mm_store_ps(f->ic1 + lane0, ic1);
+        _mm_store_ps(f->ic2 + lane0, ic2);
+    }
+};
+
+struct LadderStepSse2 {
+    __m128 g, k, g2, g3, g4, inv, h, s1, s2, s3, s4;
+
+    LadderStepSse2(const LadderLanes* f, size_t lane0) :
+        g(_mm_load_ps(f->g + lane0)), k(_mm_load_ps(f->k + lane0)),
+        s1(_mm_load_ps(f->s1 + lane0)), s2(_mm_load_ps(f->s2 + lane0)),
+        s3(_mm_load_ps(f->s3 + lane0)), s4(_mm_load_ps(f->s4 + lane0)) {
+        g2 = _mm_mul_ps(g, g);
+        g3 = _mm_mul_ps(g2, g);
+        g4 = _mm_mul_ps(g3, g);
+        __m128 one = _mm_set1_ps(1.f);
+        inv = _mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(k, g4)));
+        h = _mm_sub_ps(one, g);
+    }
+
+    __m128 Stage(__m128 x, __m128* s) {
+        __m128 v = _mm_mul_ps(_mm_sub_ps(x, *s), g);
+        __m128 y = _mm_add_ps(v, *s);
+        *s = _mm_add_ps(y, v);
+        return y;
+    }
+
+    __m128 Step(__m128 x) {
+        __m128 S = _mm_mul_ps(h, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(g3, s1), _mm_mul_ps(g2, s2)), _mm_mul_ps(g, s3)), s4));
+        __m128 y4 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(g4, x), S), inv);
+        __m128 u = SoftClipSse2(_mm_sub_ps(x, _mm_mul_ps(k, y4)));
+        u = Stage(u, &s1);
+        u = Stage(u, &s2);
+        u = Stage(u, &s3);
+        return Stage(u, &s4);
+    }
+
+    void Store(LadderLanes* f, size_t lane0) {
+        _mm_store_ps(f->s1 + lane0, s1);
+        _mm_store_ps(f->s2 + lane0, s2);
+        _mm_store_ps(f->s3 + lane0, s3);
+        _mm_store_ps(f->s4 + lane0, s4);
+    }
+};
+
+// Runs a 4 lane filter over up to 4 voices. Four samples of each voice
+// are loaded and transposed, so each step sees one sample of every voice.
+template <typename Filter>
+void FilterLanesSse2(Filter& filter, float* voices, size_t stride, size_t numLanes, size_t n) {
+    // Missing voices read lane 0's samples and aren't written
+    float* rows[4];
+    for (size_t l = 0; l < 4; l++) {
+        rows[l] = voices + (l < numLanes ? l : 0) * stride;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 r0 = _mm_loadu_ps(rows[0] + i);
+        __m128 r1 = _mm_loadu_ps(rows[1] + i);
+        __m128 r2 = _mm_loadu_ps(rows[2] + i);
+        __m128 r3 = _mm_loadu_ps(rows[3] + i);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        r0 = filter.Step(r0);
+        r1 = filter.Step(r1);
+        r2 = filter.Step(r2);
+        r3 = filter.Step(r3);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        __m128 out[4] = { r0, r1, r2, r3 };
+        for (size_t l = 0; l < numLanes; l++) {
+            _mm_storeu_ps(rows[l] + i, out[l]);
+        }
+    }
+    for (; i < n; i++) {
+        alignas(16) float x[4];
+        for (size_t l = 0; l < 4; l++) {
+            x[l] = rows[l][i];
+        }
+        _mm_store_ps(x, filter.Step(_mm_load_ps(x)));
+        for (size_t l = 0; l < numLanes; l++) {
+            rows[l][i] = x[l];
+        }
+    }
+}
+
+void SvfSse2(SvfLanes* f, float* voices, size_t stride, size_t numLanes, size_t n) {
+    for (size_t lane0 = 0; lane0 < numLanes; lane0 += 4) {
+        SvfStepSse2 filter(f, lane0);
+        FilterLanesSse2(filter, voices + lane0 * stride, stride, std::min(numLanes - lane0, (size_t)4), n);
+        filter.Store(f, lane0);
+    }
+}
+
+void LadderSse2(LadderLanes* f, float* voices, size_t stride, size_t numLanes, size_t n) {
+    for (size_t lane0 = 0; lane0 < numLanes; lane0 += 4) {
+        LadderStepSse2 filter(f, lane0);
+        FilterLanesSse2(filter, voices + lane0 * stride, stride, std::min(numLanes - lane0, (size_t)4), n);
+        filter.Store(f, lane0);
+    }
+}
+
+// The Hadamard mix needs all 8 lines at once, so each step takes lines 0-3
+// and 4-7 as a pair. A butterfly is a + b in one lane and a - b in the
+// other, done as swap(y) + y with y's sign flipped in the second lane.
+struct FdnStepSse2 {
+    __m128 c[2], gain[2], inject[2], lp[2];
+    const float* in;
+    size_t i = 0;
+
+    FdnStepSse2(const FdnLanes* f, const float* input) : in(input) {
+        for (size_t h = 0; h < 2; h++) {
+            c[h] = _mm_load_ps(f->c + 4 * h);
+            gain[h] = _mm_load_ps(f->gain + 4 * h);
+            inject[h] = _mm_load_ps(f->inject + 4 * h);
+            lp[h] = _mm_load_ps(f->lp + 4 * h);
+        }
+    }
+
+    void Step(__m128* x) {
+        const __m128 flip1 = _mm_set_ps(-0.f, 0.f, -0.f, 0.f);
+        const __m128 flip2 = _mm_set_ps(-0.f, -0.f, 0.f, 0.f);
+        __m128 y[2];
+        for (size_t h = 0; h < 2; h++) {
+            lp[h] = _mm_add_ps(lp[h], _mm_mul_ps(c[h], _mm_sub_ps(x[h], lp[h])));
+            y[h] = _mm_mul_ps(lp[h], gain[h]);
+            y[h] = _mm_add_ps(_mm_shuffle_ps(y[h], y[h], _MM_SHUFFLE(2, 3, 0, 1)), _mm_xor_ps(y[h], flip1));
+            y[h] = _mm_add_ps(_mm_shuffle_ps(y[h], y[h], _MM_SHUFFLE(1, 0, 3, 2)), _mm_xor_ps(y[h], flip2));
+        }
+        __m128 input = _mm_set1_ps(in[i++]);
+        x[0] = _mm_add_ps(_mm_add_ps(y[0], y[1]), _mm_mul_ps(inject[0], input));
+        x[1] = _mm_add_ps(_mm_sub_ps(y[0], y[1]), _mm_mul_ps(inject[1], input));
+    }
+
+    void Store(FdnLanes* f) {
+        _mm_store_ps(f->lp, lp[0]);
+        _mm_store_ps(f->lp + 4, lp[1]);
+    }
+};
+
+void FdnSse2(FdnLanes* f, float* lines, size_t stride, const float* in, size_t n) {
+    FdnStepSse2 fdn(f, in);
+    float* rows[FDN_LINES];
+    for (size_t l = 0; l < FDN_LINES; l++) {
+        rows[l] = lines + l * stride;
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 r[FDN_LINES];
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            r[l] = _mm_loadu_ps(rows[l] + i);
+        }
+        _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+        _MM_TRANSPOSE4_PS(r[4], r[5], r[6], r[7]);
+        for (size_t t = 0; t < 4; t++) {
+            __m128 x[2] = { r[t], r[4 + t] };
+            fdn.Step(x);
+            r[t] = x[0];
+            r[4 + t] = x[1];
+        }
+        _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+        _MM_TRANSPOSE4_PS(r[4], r[5], r[6], r[7]);
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            _mm_storeu_ps(rows[l] + i, r[l]);
+        }
+    }
+    for (; i < n; i++) {
+        alignas(16) float x[FDN_LINES];
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            x[l] = rows[l][i];
+        }
+        __m128 v[2] = { _mm_load_ps(x), _mm_load_ps(x + 4) };
+        fdn.Step(v);
+        _mm_store_ps(x, v[0]);
+        _mm_store_ps(x + 4, v[1]);
+        for (size_t l = 0; l < FDN_LINES; l++) {
+            rows[l][i] = x[l];
+        }
+    }
+    fdn.Store(f);
+}
+
+// Interpolation of 4 lanes, y[k] holding tap k - 1 of each lane
+template <bool CUBIC>
+inline __m128 InterpolateSse2(const __m128* y, __m128 frac) {
+    if (!CUBIC) {
+        return _mm_add_ps(y[1], _mm_mul_ps(frac, _mm_sub_ps(y[2], y[1])));
+    }
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(y[2], y[0]));
+    __m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(y[0], _mm_mul_ps(_mm_set1_ps(2.5f), y[1])), _mm_mul_ps(_mm_set1_ps(2.f), y[2])), _mm_mul_ps(half, y[3]));
+    __m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(y[3], y[0])), _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(y[1], y[2])));
+    return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, frac), c2), frac), c1), frac), y[1]);
+}
+
+// 4 lanes starting at lane0, one frame. SSE2 has no gather, the taps are
+// loaded one by one.
+template <bool CUBIC>
+inline __m128 UnisonStepSse2(__m128i* phase, __m128i increment, const float* table, __m128i shift, __m128i fracMask, __m128 fracScale) {
+    alignas(16) uint32_t index[4];
+    _mm_store_si128((__m128i*)index, _mm_srl_epi32(*phase, shift));
+    __m128 frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(*phase, fracMask)), fracScale);
+    __m128 y[4];
+    for (int k = (CUBIC ? 0 : 1); k < (CUBIC ? 4 : 3); k++) {
+        const float* t = table + k - 1;
+        y[k] = _mm_set_ps(t[index[3]], t[index[2]], t[index[1]], t[index[0]]);
+    }
+    *phase = _mm_add_epi32(*phase, increment);
+    return InterpolateSse2<CUBIC>(y, frac);
+}
+
+// Four frames at a time: each step gives one frame of 4 lanes, and a 4x4
+// transpose turns them into 4 frames of each lane for the mix
+template <bool CUBIC>
+void UnisonSse2(UnisonLanes* u, const float* table, uint32_t tableBits, float* left, float* right, size_t n) {
+    __m128i shift = _mm_cvtsi32_si128((int)(32 - tableBits));
+    __m128i fracMask = _mm_set1_epi32((int)((1u << (32 - tableBits)) - 1));
+    __m128 fracScale = _mm_set1_ps(1.f / (float)(1u << (32 - tableBits)));
+    __m128i phase[2], increment[2];
+    for (size_t h = 0; h < 2; h++) {
+        phase[h] = _mm_load_si128((const __m128i*)(u->phase + 4 * h));
+        increment[h] = _mm_load_si128((const __m128i*)(u->increment + 4 * h));
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        for (size_t h = 0; h < 2; h++) {
+            __m128 x[4];
+            for (size_t t = 0; t < 4; t++) {
+                x[t] = UnisonStepSse2<CUBIC>(&phase[h], increment[h], table, shift, fracMask, fracScale);
+            }
+            _MM_TRANSPOSE4_PS(x[0], x[1], x[2], x[3]);
+            for (size_t c = 0; c < 4; c++) {
+                l = _mm_add_ps(l, _mm_mul_ps(_mm_set1_ps(u->gainLeft[4 * h + c]), x[c]));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(u->gainRight[4 * h + c]), x[c]));
+            }
+        }
+        _mm_storeu_ps(left + i, l);
+        _mm_storeu_ps(right + i, r);
+    }
+    for (; i < n; i++) {
+        alignas(16) float copies[UNISON_LANES];
+        for (size_t h = 0; h < 2; h++) {
+            _mm_store_ps(copies + 4 * h, UnisonStepSse2<CUBIC>(&phase[h], increment[h], table, shift, fracMask, fracScale));
+        }
+        UnisonMixOne(u, copies, &left[i], &right[i]);
+    }
+
+    for (size_t h = 0; h < 2; h++) {
+        _mm_store_si128((__m128i*)(u->phase + 4 * h), phase[h]);
+    }
+}
+
+void UnisonSse2(UnisonLanes* u, const float* table, uint32_t tableBits, bool cubic, float* left, float* right, size_t n) {
+    if (cubic) {
+        UnisonSse2<true>(u, table, tableBits, left, right, n);
+    } else {
+        UnisonSse2<false>(u, table, tableBits, left, right, n);
+    }
+}
+
+// Consecutive frames in the lanes, each stepping 4 frames ahead
+void ResampleSse2(const float* in, uint32_t position, uint32_t increment, uint32_t fracBits, float* out, size_t n) {
+    __m128i shift = _mm_cvtsi32_si128((int)fracBits);
+    __m128i fracMask = _mm_set1_epi32((int)((1u << fracBits) - 1));
+    __m128 fracScale = _mm_set1_ps(1.f / (float)(1u << fracBits));
+    __m128i phase = _mm_add_epi32(_mm_set1_epi32((int)position), _mm_set_epi32((int)(3 * increment), (int)(2 * increment), (int)increment, 0));
+    __m128i step = _mm_set1_epi32((int)(4 * increment));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, UnisonStepSse2<true>(&phase, step, in, shift, fracMask, fracScale));
+    }
+    ResampleScalar(in, position + (uint32_t)i * increment, increment, fracBits, out + i, n - i);
+}
+
+//-----------------------
+// AVX2
+//-----------------------
+
+#define AVX2_FN __attribute__((target("avx2")))
+
+AVX2_FN inline __m256 SineAvx2(__m256 x) {
+    const __m256 signMask = _mm256_set1_ps(-0.f);
+    __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(INV_TWOPI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_sub_ps(_mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(TWOPI_HI))), _mm256_mul_ps(k, _mm256_set1_ps(TWOPI_LO)));
+
+    __m256 sign = _mm256_and_ps(x, signMask);
+    __m256 absX = _mm256_andnot_ps(signMask, x);
+    __m256 fold = _mm256_cmp_ps(absX, _mm256_set1_ps(HALF_PI), _CMP_GT_OQ);
+    __m256 folded = _mm256_sub_ps(_mm256_or_ps(_mm256_set1_ps(PI), sign), x);
+    x = _mm256_blendv_ps(x, folded, fold);
+
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(C11);
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(C9));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(C7));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(1.f));
+    return _mm256_mul_ps(p, x);
+}
+
+AVX2_FN void SineAvx2(const float* phase, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, SineAvx2(_mm256_loadu_ps(phase + i)));
+    }
+    for (; i < n; i++) {
+        out[i] = SineOne(phase[i]);
+    }
+}
+
+AVX2_FN void NoiseAvx2(NoiseState* state, float* out, size_t n) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)state->lanes);
+    const __m256i one = _mm256_set1_epi32(0x3f800000);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+        x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+        __m256 f = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(x, 9), one));
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_mul_ps(f, _mm256_set1_ps(2.f)), _mm256_set1_ps(3.f)));
+    }
+    _mm256_storeu_si256((__m256i*)state->lanes, x);
+    NoiseTail(state, out, i, n);
+}
+
+AVX2_FN void GainAvx2(const float* in, float* out, float gain, size_t n) {
+    __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), g));
+    }
+    for (; i < n; i++) {
+        out[i] = in[i] * gain;
+    }
+}
+
+AVX2_FN void PanAvx2(const float* in, float* left, float* right, float gainLeft, float gainRight, size_t n) {
+    __m256 gl = _mm256_set1_ps(gainLeft);
+    __m256 gr = _mm256_set1_ps(gainRight);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(in + i);
+        _mm256_storeu_ps(left + i, _mm256_mul_ps(x, gl));
+        _mm256_storeu_ps(right + i, _mm256_mul_ps(x, gr));
+    }
+    PanScalar(in + i, left + i, right + i, gainLeft, gainRight, n - i);
+}
+
+AVX2_FN void InterleaveAvx2(const float* left, const float* right, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 l = _mm256_loadu_ps(left + i);
+        __m256 r = _mm256_loadu_ps(right + i);
+        // unpack works within 128-bit halves, so fix up the order after
+        __m256 lo = _mm256_unpacklo_ps(l, r);
+        __m256 hi = _mm256_unpackhi_ps(l, r);
+        _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    InterleaveScalar(left + i, right + i, out + 2 * i, n - i);
+}
+
+AVX2_FN void ButterflyAvx2(float* aRe, float* aIm, float* bRe, float* bIm, const float* wRe, const float* wIm, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 br = _mm256_loadu_ps(bRe + i);
+        __m256 bi = _mm256_loadu_ps(bIm + i);
+        __m256 wr = _mm256_loadu_ps(wRe + i);
+        __m256 wi = _mm256_loadu_ps(wIm + i);
+        __m256 tr = _mm256_sub_ps(_mm256_mul_ps(br, wr), _mm256_mul_ps(bi, wi));
+        __m256 ti = _mm256_add_ps(_mm256_mul_ps(br, wi), _mm256_mul_ps(bi, wr));
+        __m256 ar = _mm256_loadu_ps(aRe + i);
+        __m256 ai = _mm256_loadu_ps(aIm + i);
+        _mm256_storeu_ps(bRe + i, _mm256_sub_ps(ar, tr));
+        _mm256_storeu_ps(bIm + i, _mm256_sub_ps(ai, ti));
+        _mm256_storeu_ps(aRe + i, _mm256_add_ps(ar, tr));
+        _mm256_storeu_ps(aIm + i, _mm256_add_ps(ai, ti));
+    }
+    // Non-VEX code runs very slowly while the upper halves of the ymm
+    // registers are dirty, so clear them before handing off the tail
+    _mm256_zeroupper();
+    ButterflySse2(aRe + i, aIm + i, bRe + i, bIm + i, wRe + i, wIm + i, n - i);
+}
+
+AVX2_FN void Dot2Avx2(const float* coeffs, const float* a, const float* b, size_t n, float* outA, float* outB) {
+    __m256 sumA = _mm256_setzero_ps();
+    __m256 sumB = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 c = _mm256_loadu_ps(coeffs + i);
+        sumA = _mm256_add_ps(sumA, _mm256_mul_ps(c, _mm256_loadu_ps(a + i)));
+        sumB = _mm256_add_ps(sumB, _mm256_mul_ps(c, _mm256_loadu_ps(b + i)));
+    }
+    __m128 a4 = _mm_add_ps(_mm256_castps256_ps128(sumA), _mm256_extractf128_ps(sumA, 1));
+    __m128 b4 = _mm_add_ps(_mm256_castps256_ps128(sumB), _mm256_extractf128_ps(sumB, 1));
+    float totalA = HorizontalSumSse2(a4);
+    float totalB = HorizontalSumSse2(b4);
+    for (; i < n; i++) {
+        totalA += coeffs[i] * a[i];
+        totalB += coeffs[i] * b[i];
+    }
+    *outA = totalA;
+    *outB = totalB;
+}
+
+AVX2_FN void FirAvx2(const float* coeffs, size_t taps, const float* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        for (size_t j = 0; j < taps; j++) {
+            __m256 c = _mm256_set1_ps(coeffs[j]);
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(c, _mm256_loadu_ps(in + i + j)));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(c, _mm256_loadu_ps(in + i + j + 8)));
+        }
+        _mm256_storeu_ps(out + i, sum0);
+        _mm256_storeu_ps(out + i + 8, sum1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (size_t j = 0; j < taps; j++) {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(coeffs[j]), _mm256_loadu_ps(in + i + j)));
+        }
+        _mm256_storeu_ps(out + i, sum);
+    }
+    // Scalar tail inline, calling FirScalar here would run it as non-VEX
+    // SSE with dirty upper halves
+    for (; i < n; i++) {
+        float sum = 0.f;
+        for (size_t j = 0; j < taps; j++) {
+            sum += coeffs[j] * in[i + j];
+        }
+        out[i] = sum;
+    }
+}
+
+AVX2_FN void SaturateAvx2(const float* in, float* out, float gain0, float gain1, float mix0, float mix1, size_t n) {
+    float gainStep = (gain1 - gain0) / (float)n;
+    float mixStep = (mix1 - mix0) / (float)n;
+    __m256 g0 = _mm256_set1_ps(gain0);
+    __m256 gs = _mm256_set1_ps(gainStep);
+    __m256 m0 = _mm256_set1_ps(mix0);
+    __m256 ms = _mm256_set1_ps(mixStep);
+    __m256 lo = _mm256_set1_ps(-3.f);
+    __m256 hi = _mm256_set1_ps(3.f);
+    __m256 c27 = _mm256_set1_ps(27.f);
+    __m256 c9 = _mm256_set1_ps(9.f);
+    __m256 t = _mm256_setr_ps(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);
+    __m256 eight = _mm256_set1_ps(8.f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(in + i);
+        __m256 mix = _mm256_add_ps(m0, _mm256_mul_ps(ms, t));
+        __m256 y = _mm256_mul_ps(x, _mm256_add_ps(g0, _mm256_mul_ps(gs, t)));
+        y = _mm256_max_ps(_mm256_min_ps(y, hi), lo);
+        __m256 y2 = _mm256_mul_ps(y, y);
+        __m256 wet = _mm256_div_ps(_mm256_mul_ps(y, _mm256_add_ps(c27, y2)), _mm256_add_ps(c27, _mm256_mul_ps(c9, y2)));
+        _mm256_storeu_ps(out + i, _mm256_add_ps(x, _mm256_mul_ps(mix, _mm256_sub_ps(wet, x))));
+        t = _mm256_add_ps(t, eight);
+    }
+    _mm256_zeroupper(); // in case SaturateOne isn't inlined
+    for (; i < n; i++) {
+        float ti = (float)(i + 1);
+        out[i] = SaturateOne(in[i], gain0 + gainStep * ti, mix0 + mixStep * ti);
+    }
+}
+
+template <bool ADD>
+AVX2_FN void RampAvx2(const float* in, float* out, float gain0, float gain1, size_t n) {
+    float step = (gain1 - gain0) / (float)n;
+    __m256 g0 = _mm256_set1_ps(gain0);
+    __m256 gs = _mm256_set1_ps(step);
+    __m256 t = _mm256_setr_ps(1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f);
+    __m256 eight = _mm256_set1_ps(8.f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 y = _mm256_mul_ps(_mm256_loadu_ps(in + i), _mm256_add_ps(g0, _mm256_mul_ps(gs, t)));
+        if (ADD) {
+            y = _mm256_add_ps(_mm256_loadu_ps(out + i), y);
+        }
+        _mm256_storeu_ps(out + i, y);
+        t = _mm256_add_ps(t, eight);
+    }
+    for (; i < n; i++) {
+        float y = in[i] * (gain0 + step * (float)(i + 1));
+        out[i] = (ADD ? out[i] + y : y);
+    }
+}
+
+AVX2_FN inline __m256 SoftClipAvx2(__m256 x) {
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(3.f)), _mm256_set1_ps(-3.f));
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 c27 = _mm256_set1_ps(27.f);
+    return _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c27, x2)), _mm256_add_ps(c27, _mm256_mul_ps(_mm256_set1_ps(9.f), x2)));
+}
+
+struct SvfStepAvx2 {
+    __m256 a1, a2, a3, m0, m1, m2, ic1, ic2;
+
+    AVX2_FN explicit SvfStepAvx2(const SvfLanes* f) :
+        a1(_mm256_load_ps(f->a1)), a2(_mm256_load_ps(f->a2)), a3(_mm256_load_ps(f->a3)),
+        m0(_mm256_load_ps(f->m0)), m1(_mm256_load_ps(f->m1)), m2(_mm256_load_ps(f->m2)),
+        ic1(_mm256_load_ps(f->ic1)), ic2(_mm256_load_ps(f->ic2)) {}
+
+    AVX2_FN __m256 Step(__m256 x) {
+        __m256 v3 = _mm256_sub_ps(x, ic2);
+        __m256 v1 = _mm256_add_ps(_mm256_mul_ps(a1, ic1), _mm256_mul_ps(a2, v3));
+        __m256 v2 = _mm256_add_ps(_mm256_add_ps(ic2, _mm256_mul_ps(a2, ic1)), _mm256_mul_ps(a3, v3));
+        ic1 = _mm256_sub_ps(_mm256_add_ps(v1, v1), ic1);
+        ic2 = _mm256_sub_ps(_mm256_add_ps(v2, v2), ic2);
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m1, v1)), _mm256_mul_ps(m2, v2));
+    }
+
+    AVX2_FN void Store(SvfLanes* f) {
+        _mm256_store_ps(f->ic1, ic1);
+        _mm256_store_ps(f->ic2, ic2);
+    }
+};
+
+struct LadderStepAvx2 {
+    __m256 g, k, g2, g3, g4, inv, h, s1, s2, s3, s4;
+
+    AVX2_FN explicit LadderStepAvx2(const LadderLanes* f) :
+        g(_mm256_load_ps(f->g)), k(_mm256_load_ps(f->k)),
+        s1(_mm256_load_ps(f->s1)), s2(_mm256_load_ps(f->s2)),
+        s3(_mm256_load_ps(f->s3)), s4(_mm256_load_ps(f->s4)) {
+        g2 = _mm256_mul_ps(g, g);
+        g3 = _mm256_mul_ps(g2, g);
+        g4 = _mm256_mul_ps(g3, g);
+        __m256 one = _mm256_set1_ps(1.f);
+        inv = _mm256_div_ps(one, _mm256_add_ps(one, _mm256_mul_ps(k, g4)));
+        h = _mm256_sub_ps(one, g);
+    }
+
+    AVX2_FN __m256 Stage(__m256 x, __m256* s) {
+        __m256 v = _mm256_mul_ps(_mm256_sub_ps(x, *s), g);
+        __m256 y = _mm256_add_ps(v, *s);
+        *s = _mm256_add_ps(y, v);
+        return y;
+    }
+
+    AVX2_FN __m256 Step(__m256 x) {
+        __m256 S = _mm256_mul_ps(h, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(g3, s1), _mm256_mul_ps(g2, s2)), _mm256_mul_ps(g, s3)), s4));
+        __m256 y4 = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(g4, x), S), inv);
+        __m256 u = SoftClipAvx2(_mm256_sub_ps(x, _mm256_mul_ps(k, y4)));
+        u = Stage(u, &s1);
+        u = Stage(u, &s2);
+        u = Stage(u, &s3);
+        return Stage(u, &s4);
+    }
+
+    AVX2_FN void Store(LadderLanes* f) {
+        _mm256_store_ps(f->s1, s1);
+        _mm256_store_ps(f->s2, s2);
+        _mm256_store_ps(f->s3, s3);
+        _mm256_store_ps(f->s4, s4);
+    }
+};
+
+AVX2_FN inline void Transpose8Avx2(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+// All 8 lanes in one register, with 8x8 transposes
+template <typename Filter>
+AVX2_FN void FilterLanesAvx2(Filter& filter, float* voices, size_t stride, size_t numLanes, size_t n) {
+    float* rows[FILTER_LANES];
+    for (size_t l = 0; l < FILTER_LANES; l++) {
+        rows[l] = voices + (l < numLanes ? l : 0) * stride;
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 r[8];
+        for (size_t l = 0; l < 8; l++) {
+            r[l] = _mm256_loadu_ps(rows[l] + i);
+        }
+        Transpose8Avx2(r);
+        for (size_t t = 0; t < 8; t++) {
+            r[t] = filter.Step(r[t]);
+        }
+        Transpose8Avx2(r);
+        for (size_t l = 0; l < numLanes; l++) {
+            _mm256_storeu_ps(rows[l] + i, r[l]);
+        }
+    }
+    for (; i < n; i++) {
+        alignas(32) float x[8];
+        for (size_t l = 0; l < 8; l++) {
+            x[l] = rows[l][i];
+        }
+        _mm256_store_ps(x, filter.Step(_mm256_load_ps(x)));
+        for (size_t l = 0; l < numLanes; l++) {
+            rows[l][i] = x[l];
+        }
+    }
+}
+
+// Same butterflies as FdnStepSse2, the last one across the two halves
+struct FdnStepAvx2 {
+    __m256 c, gain, inject, lp;
+    const float* in;
+    size_t i = 0;
+
+    AVX2_FN FdnStepAvx2(const FdnLanes* f, const float* input) :
+        c(_mm256_load_ps(f->c)), gain(_mm256_load_ps(f->gain)),
+        inject(_mm256_load_ps(f->inject)), lp(_mm256_load_ps(f->lp)), in(input) {}
+
+    AVX2_FN __m256 Step(__m256 x) {
+        const __m256 flip1 = _mm256_set_ps(-0.f, 0.f, -0.f, 0.f, -0.f, 0.f, -0.f, 0.f);
+        const __m256 flip2 = _mm256_set_ps(-0.f, -0.f, 0.f, 0.f, -0.f, -0.f, 0.f, 0.f);
+        const __m256 flip4 = _mm256_set_ps(-0.f, -0.f, -0.f, -0.f, 0.f, 0.f, 0.f, 0.f);
+        lp = _mm256_add_ps(lp, _mm256_mul_ps(c, _mm256_sub_ps(x, lp)));
+        __m256 y = _mm256_mul_ps(lp, gain);
+        y = _mm256_add_ps(_mm256_permute_ps(y, _MM_SHUFFLE(2, 3, 0, 1)), _mm256_xor_ps(y, flip1));
+        y = _mm256_add_ps(_mm256_permute_ps(y, _MM_SHUFFLE(1, 0, 3, 2)), _mm256_xor_ps(y, flip2));
+        y = _mm256_add_ps(_mm256_permute2f128_ps(y, y, 0x01), _mm256_xor_ps(y, flip4));
+        return _mm256_add_ps(y, _mm256_mul_ps(inject, _mm256_set1_ps(in[i++])));
+    }
+
+    AVX2_FN void Store(FdnLanes* f) {
+        _mm256_store_ps(f->lp, lp);
+    }
+};
+
+AVX2_FN void SvfAvx2(SvfLanes* f, float* voices, size_t stride, size_t numLanes, size_t n) {
+    SvfStepAvx2 filter(f);
+    FilterLanesAvx2(filter, voices, stride, numLanes, n);
+    filter.Store(f);
+}
+
+AVX2_FN void LadderAvx2(LadderLanes* f, float* voices, size_t stride, size_t numLanes, size_t n) {
+    LadderStepAvx2 filter(f);
+    FilterLanesAvx2(filter, voices, stride, numLanes, n);
+    filter.Store(f);
+}
+
+AVX2_FN void FdnAvx2(FdnLanes* f, float* lines, size_t stride, const float* in, size_t n) {
+    FdnStepAvx2 fdn(f, in);
+    FilterLanesAvx2(fdn, lines, stride, FDN_LINES, n);
+    fdn.Store(f);
+}
+
+// Same operations as InterpolateSse2, all 8 lanes with gathers
+template <bool CUBIC>
+AVX2_FN inline __m256 UnisonStepAvx2(__m256i* phase, __m256i increment, const float* table, __m128i shift, __m256i fracMask, __m256 fracScale) {
+    __m256i index = _mm256_srl_epi32(*phase, shift);
+    __m256 frac = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(*phase, fracMask)), fracScale);
+    *phase = _mm256_add_epi32(*phase, increment);
+    __m256 y0 = _mm256_i32gather_ps(table, index, 4);
+    __m256 y1 = _mm256_i32gather_ps(table + 1, index, 4);
+    if (!CUBIC) {
+        return _mm256_add_ps(y0, _mm256_mul_ps(frac, _mm256_sub_ps(y1, y0)));
+    }
+    __m256 ym1 = _mm256_i32gather_ps(table - 1, index, 4);
+    __m256 y2 = _mm256_i32gather_ps(table + 2, index, 4);
+    __m256 half = _mm256_set1_ps(0.5f);
+    __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(y1, ym1));
+    __m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(ym1, _mm256_mul_ps(_mm256_set1_ps(2.5f), y0)), _mm256_mul_ps(_mm256_set1_ps(2.f), y1)), _mm256_mul_ps(half, y2));
+    __m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(y2, ym1)), _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(y0, y1)));
+    return _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(c3, frac), c2), frac), c1), frac), y0);
+}
+
+// Eight frames at a time, transposed so each register is 8 frames of one
+// lane for the mix
+template <bool CUBIC>
+AVX2_FN void UnisonAvx2(UnisonLanes* u, const float* table, uint32_t tableBits, float* left, float* right, size_t n) {
+    __m128i shift = _mm_cvtsi32_si128((int)(32 - tableBits));
+    __m256i fracMask = _mm256_set1_epi32((int)((1u << (32 - tableBits)) - 1));
+    __m256 fracScale = _mm256_set1_ps(1.f / (float)(1u << (32 - tableBits)));
+    __m256i phase = _mm256_load_si256((const __m256i*)u->phase);
+    __m256i increment = _mm256_load_si256((const __m256i*)u->increment);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x[8];
+        for (size_t t = 0; t < 8; t++) {
+            x[t] = UnisonStepAvx2<CUBIC>(&phase, increment, table, shift, fracMask, fracScale);
+        }
+        Transpose8Avx2(x);
+        __m256 l = _mm256_loadu_ps(left + i);
+        __m256 r = _mm256_loadu_ps(right + i);
+        for (size_t c = 0; c < UNISON_LANES; c++) {
+            l = _mm256_add_ps(l, _mm256_mul_ps(_mm256_set1_ps(u->gainLeft[c]), x[c]));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(u->gainRight[c]), x[c]));
+        }
+        _mm256_storeu_ps(left + i, l);
+        _mm256_storeu_ps(right + i, r);
+    }
+    for (; i < n; i++) {
+        alignas(32) float copies[UNISON_LANES];
+        _mm256_store_ps(copies, UnisonStepAvx2<CUBIC>(&phase, increment, table, shift, fracMask, fracScale));
+        UnisonMixOne(u, copies, &left[i], &right[i]);
+    }
+    _mm256_store_si256((__m256i*)u->phase, phase);
+}
+
+AVX2_FN void UnisonAvx2(UnisonLanes* u, const float* table, uint32_t tableBits, bool cubic, float* left, float* right, size_t n) {
+    if (cubic) {
+        UnisonAvx2<true>(u, table, tableBits, left, right, n);
+    } else {
+        UnisonAvx2<false>(u, table, tableBits, left, right, n);
+    }
+}
+
+AVX2_FN void ResampleAvx2(const float* in, uint32_t position, uint32_t increment, uint32_t fracBits, float* out, size_t n) {
+    __m128i shift = _mm_cvtsi32_si128((int)fracBits);
+    __m256i fracMask = _mm256_set1_epi32((int)((1u << fracBits) - 1));
+    __m256 fracScale = _mm256_set1_ps(1.f / (float)(1u << fracBits));
+    __m256i lanes = _mm256_mullo_epi32(_mm256_set1_epi32((int)increment), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i phase = _mm256_add_epi32(_mm256_set1_epi32((int)position), lanes);
+    __m256i step = _mm256_set1_epi32((int)(8 * increment));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, UnisonStepAvx2<true>(&phase, step, in, shift, fracMask, fracScale));
+    }
+    ResampleScalar(in, position + (uint32_t)i * increment, increment, fracBits, out + i, n - i);
+}
+
+#endif // KERNELS_X86
+
+struct Table {
+    const char* name;
+    void (*sine)(const float*, float*, size_t);
+    void (*noise)(NoiseState*, float*, size_t);
+    void (*gain)(const float*, float*, float, size_t);
+    void (*pan)(const float*, float*, float*, float, float, size_t);
+    void (*interleave)(const float*, const float*, float*, size_t);
+    void (*butterfly)(float*, float*, float*, float*, const float*, const float*, size_t);
+    void (*dot2)(const float*, const float*, const float*, size_t, float*, float*);
+    void (*fir)(const float*, size_t, const float*, float*, size_t);
+    void (*saturate)(const float*, float*, float, float, float, float, size_t);
+    void (*ramp)(const float*, float*, float, float, size_t);
+    void (*addRamp)(const float*, float*, float, float, size_t);
+    void (*svf)(SvfLanes*, float*, size_t, size_t, size_t);
+    void (*ladder)(LadderLanes*, float*, size_t, size_t, size_t);
+    void (*fdn)(FdnLanes*, float*, size_t, const float*, size_t);
+    void (*unison)(UnisonLanes*, const float*, uint32_t, bool, float*, float*, size_t);
+    void (*resample)(const float*, uint32_t, uint32_t, uint32_t, float*, size_t);
+};
+
+constexpr Table SCALAR = { "scalar", SineScalar, NoiseScalar, GainScalar, PanScalar, InterleaveScalar, ButterflyScalar, Dot2Scalar, FirScalar, SaturateScalar, RampScalar, AddRampScalar, SvfScalar, LadderScalar, FdnScalar, UnisonScalar, ResampleScalar };
+#ifdef KERNELS_X86
+constexpr Table SSE2 = { "SSE2", SineSse2, NoiseSse2, GainSse2, PanSse2, InterleaveSse2, ButterflySse2, Dot2Sse2, FirSse2, SaturateSse2, RampSse2<false>, RampSse2<true>, SvfSse2, LadderSse2, FdnSse2, UnisonSse2, ResampleSse2 };
+constexpr Table AVX2 = { "AVX2", SineAvx2, NoiseAvx2, GainAvx2, PanAvx2, InterleaveAvx2, ButterflyAvx2, Dot2Avx2, FirAvx2, SaturateAvx2, RampAvx2<false>, RampAvx2<true>, SvfAvx2, LadderAvx2, FdnAvx2, UnisonAvx2, ResampleAvx2 };
+#endif
+
+const Table* _table = &SCALAR;
+
+} // namespace
+
+void Init() {
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        _table = &AVX2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        _table = &SSE2;
+    }
+#endif
+}
+
+const char* Name() {
+    return _table->name;
+}
+
+void FlushDenormals() {
+#ifdef KERNELS_X86
+    _mm_setcsr(_mm_getcsr() | 0x8040); // FTZ | DAZ
+#endif
+}
+
+void NoiseState::Seed(uint32_t seed) {
+    for (size_t i = 0; i < LANES; i++) {
+        // xorshift state must be non-zero
+        uint32_t x = seed + (uint32_t)i * 0x9e3779b9u;
+        x = Xorshift(x ^ 0x6d2b79f5u);
+        lanes[i] = (x == 0 ? 1 : x);
+    }
+}
+
+void Sine(const float* phase, float* out, size_t n) {
+    _table->sine(phase, out, n);
+}
+
+void Noise(NoiseState* state, float* out, size_t n) {
+    _table->noise(state, out, n);
+}
+
+void Gain(const float* in, float* out, float gain, size_t n) {
+    _table->gain(in, out, gain, n);
+}
+
+void Pan(const float* in, float* left, float* right, float gainLeft, float gainRight, size_t n) {
+    _table->pan(in, left, right, gainLeft, gainRight, n);
+}
+
+void Interleave(const float* left, const float* right, float* out, size_t n) {
+    _table->interleave(left, right, out, n);
+}
+
+void Butterfly(float* aRe, float* aIm, float* bRe, float* bIm, const float* wRe, const float* wIm, size_t n) {
+    _table->butterfly(aRe, aIm, bRe, bIm, wRe, wIm, n);
+}
+
+void Dot2(const float* coeffs, const float* a, const float* b, size_t n, float* outA, float* outB) {
+    _table->dot2(coeffs, a, b, n, outA, outB);
+}
+
+void Fir(const float* coeffs, size_t taps, const float* in, float* out, size_t n) {
+    _table->fir(coeffs, taps, in, out, n);
+}
+
+void Saturate(const float* in, float* out, float gain0, float gain1, float mix0, float mix1, size_t n) {
+    _table->saturate(in, out, gain0, gain1, mix0, mix1, n);
+}
+
+void Ramp(const float* in, float* out, float gain0, float gain1, size_t n) {
+    _table->ramp(in, out, gain0, gain1, n);
+}
+
+void AddRamp(const float* in, float* out, float gain0, float gain1, size_t n) {
+    _table->addRamp(in, out, gain0, gain1, n);
+}
+
+void Svf(SvfLanes* filter, float* voices, size_t stride, size_t numLanes, size_t n) {
+    _table->svf(filter, voices, stride, numLanes, n);
+}
+
+void Ladder(LadderLanes* filter, float* voices, size_t stride, size_t numLanes, size_t n) {
+    _table->ladder(filter, voices, stride, numLanes, n);
+}
+
+void Fdn(FdnLanes* fdn, float* lines, size_t stride, const float* in, size_t n) {
+    _table->fdn(fdn, lines, stride, in, n);
+}
+
+void Unison(UnisonLanes* lanes, const float* table, uint32_t tableBits, bool cubic, float* left, float* right, size_t n) {
+    _table->unison(lanes, table, tableBits, cubic, left, right, n);
+}
+
+void Resample(const float* in, uint32_t position, uint32_t increment, uint32_t fracBits, float* out, size_t n) {
+    _table->resample(in, position, increment, fracBits, out, n);
+}
+
+} // namespace kernels
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Vectorized DSP building blocks. On x86 the fastest available
+// implementation (AVX2, SSE2) is picked at startup, with a scalar
+// fallback for everything else (e.g. WASM). All functions work on
+// unaligned buffers of any length.
+namespace kernels {
+
+// Pick implementations for this CPU. Call once at startup, before the
+// audio thread is running.
+void Init();
+
+// Name of the selected implementation, e.g. "AVX2"
+const char* Name();
+
+// Flush denormals to zero on the calling thread (FTZ and DAZ on x86).
+// Recursive filters decaying towards silence otherwise slow down by
+// orders of magnitude. Call at the start of every audio thread.
+void FlushDenormals();
+
+// Per-lane xorshift32 state for Noise(). Output is identical across
+// implementations for the same seed.
+struct alignas(32) NoiseState {
+    static constexpr size_t LANES = 8;
+    uint32_t lanes[LANES];
+
+    void Seed(uint32_t seed);
+};
+
+// out[i] = sin(phase[i]), polynomial approximation, phase in radians.
+// Max error about 2e-7 within a few cycles of 0.
+void Sine(const float* phase, float* out, size_t n);
+
+// Fill out with uniform white noise in [-1, 1)
+void Noise(NoiseState* state, float* out, size_t n);
+
+// out[i] = in[i] * gain. in and out may be the same buffer.
+void Gain(const float* in, float* out, float gain, size_t n);
+
+// Mono to stereo. in may be the same buffer as left or right.
+void Pan(const float* in, float* left, float* right, float gainLeft, float gainRight, size_t n);
+
+// out[2i] = left[i], out[2i+1] = right[i]
+void Interleave(const float* left, const float* right, float* out, size_t n);
+
+// Radix-2 FFT butterfly on split complex data, with t = b * w:
+// b[i] = a[i] - t, a[i] = a[i] + t
+void Butterfly(float* aRe, float* aIm, float* bRe, float* bIm, const float* wRe, const float* wIm, size_t n);
+
+// Two dot products sharing one set of coefficients, e.g. an FIR filter on
+// a stereo pair: *outA = sum(coeffs[i] * a[i]), *outB = sum(coeffs[i] * b[i])
+void Dot2(const float* coeffs, const float* a, const float* b, size_t n, float* outA, float* outB);
+
+// FIR filter written as a correlation: out[i] = sum(coeffs[j] * in[i + j])
+// for j < taps. in holds n + taps - 1 samples, history first. Symmetric
+// filters don't need their coefficients reversed.
+void Fir(const float* coeffs, size_t taps, const float* in, float* out, size_t n);
+
+// Soft clipper blended with its input:
+//   out[i] = in[i] + mix * (clip(in[i] * gain) - in[i])
+// clip is a Pade approximation of tanh that reaches +-1 at +-3. gain and
+// mix ramp linearly from their first to their second value over the
+// buffer, so they can change every block without clicks. in and out may
+// be the same buffer.
+void Saturate(const float* in, float* out, float gain0, float gain1, float mix0, float mix1, size_t n);
+
+// Gain ramped linearly from gain0 to gain1 over the buffer, reaching gain1
+// on the last sample: out[i] = in[i] * (gain0 + (gain1 - gain0) * (i + 1) / n).
+// in and out may be the same buffer.
+void Ramp(const float* in, float* out, float gain0, float gain1, size_t n);
+
+// The same, added to out: out[i] += in[i] * gain
+void AddRamp(const float* in, float* out, float gain0, float gain1, size_t n);
+
+// Per-voice filters are run side by side, one voice per SIMD lane, so a
+// group of voices costs about the same as one. Voice l's samples are at
+// voices + l * stride and are filtered in place. Only the first numLanes
+// (<= FILTER_LANES) voices are read or written. Coefficients and state
+// are per lane.
+constexpr size_t FILTER_LANES = 8;
+
+// Trapezoidal state variable filter (A. Simper, Cytomic). The output is
+// mixed from the input, band and low outputs: m0 * in + m1 * band + m2 * low
+struct alignas(32) SvfLanes {
+    float a1[FILTER_LANES];
+    float a2[FILTER_LANES];
+    float a3[FILTER_LANES];
+    float m0[FILTER_LANES];
+    float m1[FILTER_LANES];
+    float m2[FILTER_LANES];
+    float ic1[FILTER_LANES]; // state
+    float ic2[FILTER_LANES];
+};
+void Svf(SvfLanes* filter, float* voices, size_t stride, size_t numLanes, size_t n);
+
+// 4-pole lowpass ladder: four trapezoidal one-pole stages with the
+// feedback solved without a unit delay, and a soft clip at the input
+struct alignas(32) LadderLanes {
+    float g[FILTER_LANES]; // one-pole gain, G = g / (1 + g) with g = tan(pi * fc / fs)
+    float k[FILTER_LANES]; // feedback, self-oscillates from 4
+    float s1[FILTER_LANES]; // state
+    float s2[FILTER_LANES];
+    float s3[FILTER_LANES];
+    float s4[FILTER_LANES];
+};
+void Ladder(LadderLanes* filter, float* voices, size_t stride, size_t numLanes, size_t n);
+
+// Feedback delay network, one delay line per lane. lines holds a block
+// read from each line, line l at lines + l * stride, and is overwritten in
+// place with what goes back into each line. Per sample:
+//   lp = lp + c * (x - lp)
+//   x = hadamard(lp * gain) + inject * in[i]
+// The Hadamard matrix is unnormalized, gain includes its 1 / sqrt(8).
+constexpr size_t FDN_LINES = 8;
+
+struct alignas(32) FdnLanes {
+    float c[FDN_LINES]; // damping, one-pole lowpass coefficient in (0, 1]
+    float gain[FDN_LINES]; // per line, sets the decay time
+    float inject[FDN_LINES]; // input gain per line
+    float lp[FDN_LINES]; // state
+};
+void Fdn(FdnLanes* fdn, float* lines, size_t stride, const float* in, size_t n);
+
+// Unison: copies of one waveform played side by side from a wavetable,
+// one per SIMD lane, each with its own phase and increment, and mixed
+// into a stereo pair with per-copy gains:
+//   left[i] += sum(gainLeft[c] * copy_c[i]), the same for right
+// table is one mip level of 2^tableBits samples, with a guard sample
+// before and two after (see Wavetable). Phases are 32-bit accumulators
+// whose top tableBits bits index the table. Interpolation is the same as
+// Wavetable::Render(), linear or 4-point Hermite. Unused lanes must have
+// gains of 0.
+constexpr size_t UNISON_LANES = 8;
+
+struct alignas(32) UnisonLanes {
+    uint32_t phase[UNISON_LANES]; // state
+    uint32_t increment[UNISON_LANES];
+    float gainLeft[UNISON_LANES];
+    float gainRight[UNISON_LANES];
+};
+void Unison(UnisonLanes* lanes, const float* table, uint32_t tableBits, bool cubic, float* left, float* right, size_t n);
+
+// Resampling: out[i] = in[] at position + i * increment, where positions
+// are fixed point with fracBits fractional bits. Interpolated with the
+// same 4-point Hermite as the wavetables, so in[-1] up to two samples past
+// the last index read must be readable.
+void Resample(const float* in, uint32_t position, uint32_t increment, uint32_t fracBits, float* out, size_t n);
+
+} // namespace kernels
@@ -1,5 +1,10 @@
 #include "synth.h"
 #include "audio.h"
+#include "kernels.h"
+#include "render.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
 #if IS_WASM_BUILD
 #include <emscripten.h>
 #endif
@@ -10,23 +15,100 @@ static void LoopOnce(void* arg) {
     Synth* synth = (Synth*)arg;
     synth->input.PollEvents();
     synth->ui.Draw();
+    TRACE_ZONE("SDL_GL_SwapWindow");
     SDL_GL_SwapWindow(synth->sdl._window);
 }
 
 int main(int argc, char* argv[]) {
+    const char* renderScript = nullptr;
+    const char* renderWav = nullptr;
+    const char* tracePath = nullptr;
+    const char* keymapPath = nullptr;
+    const char* midiPath = nullptr;
+    uint32_t numWorkers = 0; // one per spare core
+    float engineRateHz = 0.f; // 0 = run at the device rate
+    uint32_t oversampling = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--render") == 0 && i + 2 < argc) {
+            renderScript = argv[++i];
+            renderWav = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            keymapPath = argv[++i];
+        } else if (strcmp(argv[i], "--midi") == 0 && i + 1 < argc) {
+            midiPath = argv[++i];
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            engineRateHz = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            numWorkers = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--oversample") == 0 && i + 1 < argc
+                && Oversampler::IsValidFactor((uint32_t)atoi(argv[i + 1]))) {
+            oversampling = (uint32_t)atoi(argv[++i]);
+        } else {
+            SDL_Log("Usage: %s [--render <script.txt> <out.wav>] [--trace <out.json>] [--workers <n>] [--rate <hz>] [--oversample <1|2|4|8>] [--samples <keymap.txt>] [--midi <song.mid>]", argv[0]);
+            return 1;
+        }
+    }
+
+    kernels::Init();
+    SDL_Log("DSP kernels: %s", kernels::Name());
+
     auto synth = std::make_unique<Synth>();
+    RETURN_1_IF_FALSE(synth->workers.Init(numWorkers));
+    // The starting value, a patch change brings its own
+    synth->osc.SetParam(Event::Param::Oversampling, (float)oversampling);
+    // Offline renders stream samples in step with the render
+    if (keymapPath) {
+        RETURN_1_IF_FALSE(synth->sampler.Load(keymapPath, renderScript == nullptr));
+    }
+
+    if (tracePath) {
+        RETURN_1_IF_FALSE(trace::Start(tracePath));
+    }
+
+    // Headless: no window, GL or audio device
+    if (renderScript) {
+        if (engineRateHz > 0.f) {
+            synth->sampleRateHz = engineRateHz;
+        }
+        synth->dspLoad.SetSampleRate(synth->sampleRateHz);
+        RETURN_1_IF_FALSE(synth->osc.Init(synth.get()));
+        RETURN_1_IF_FALSE(synth->effects.Init(synth->sampleRateHz));
+        if (midiPath) {
+            RETURN_1_IF_FALSE(synth->player.Load(midiPath, synth->sampleRateHz));
+        }
+        bool ok = render::RenderToFile(synth.get(), renderScript, renderWav);
+        trace::Stop();
+        synth->dspLoad.LogSummary();
+        return (ok ? 0 : 1);
+    }
 
     RETURN_1_IF_FALSE(synth->sdl.Init(
             "Synth (part 3)",
             WINDOW_WIDTH,
             WINDOW_HEIGHT,
-            (uint32_t)SAMPLE_RATE_HZ,
+            (uint32_t)DEFAULT_SAMPLE_RATE_HZ,
             SAMPLES_PER_BUFFER,
             audio::AudioCallback,
             (void*)synth.get()));
-    RETURN_1_IF_FALSE(synth->input.Init(synth.get()));
+
+    // The engine runs at the device rate unless asked for another one, in
+    // which case its output is resampled
+    float deviceRateHz = synth->sdl.AudioSampleRateHz();
+    synth->sampleRateHz = (engineRateHz > 0.f ? engineRateHz : deviceRateHz);
+    if (synth->sampleRateHz != deviceRateHz) {
+        RETURN_1_IF_FALSE(synth->resampler.Init(synth->sampleRateHz, deviceRateHz));
+    }
+    synth->dspLoad.SetSampleRate(deviceRateHz);
     RETURN_1_IF_FALSE(synth->osc.Init(synth.get()));
+    RETURN_1_IF_FALSE(synth->effects.Init(synth->sampleRateHz));
+    if (midiPath) {
+        RETURN_1_IF_FALSE(synth->player.Load(midiPath, synth->sampleRateHz));
+    }
+    RETURN_1_IF_FALSE(synth->input.Init(synth.get()));
     RETURN_1_IF_FALSE(synth->ui.Init(synth.get()));
+    synth->sdl.StartAudio();
 
 #ifdef IS_WASM_BUILD
     emscripten_set_main_loop_arg(LoopOnce, synth.get(), 60, 1);
@@ -37,6 +119,8 @@ int main(int argc, char* argv[]) {
     }
 #endif
 
+    trace::Stop();
+    synth->dspLoad.LogSummary();
     SDL_Log("Exiting");
     return 0;
 }
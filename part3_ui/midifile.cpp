@@ -0,0 +1,284 @@
+#include "midifile.h"
+#include "constants.h"
+#include "voice.h"
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <bitset>
+
+static constexpr uint8_t MIDI_NOTE_A0 = 21; // lowest key of the piano
+static constexpr uint32_t DEFAULT_US_PER_QUARTER = 500000; // 120 bpm
+
+// Bounds-checked big-endian reads. A read past the end returns zeros and
+// clears ok, so parsing can check once at the end of each event.
+struct MidiReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    bool AtEnd() const { return pos >= size; }
+
+    uint8_t U8() {
+        if (pos >= size) {
+            ok = false;
+            return 0;
+        }
+        return data[pos++];
+    }
+
+    uint32_t U16() {
+        uint32_t hi = U8();
+        return (hi << 8) | U8();
+    }
+
+    uint32_t U32() {
+        uint32_t hi = U16();
+        return (hi << 16) | U16();
+    }
+
+    // Variable length quantity, 7 bits per byte, at most 4 bytes
+    uint32_t Vlq() {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            uint8_t byte = U8();
+            value = (value << 7) | (byte & 0x7F);
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    void Skip(size_t bytes) {
+        if (bytes > size - std::min(pos, size)) {
+            ok = false;
+            pos = size;
+        } else {
+            pos += bytes;
+        }
+    }
+};
+
+// In ticks, before tempo is applied
+struct TickEvent {
+    uint64_t tick;
+    uint8_t note;
+    uint8_t velocity; // 0 is note off
+};
+
+struct TempoChange {
+    uint64_t tick;
+    uint32_t usPerQuarter;
+};
+
+static bool ReadTrack(MidiReader track, std::vector<TickEvent>* notes, std::vector<TempoChange>* tempos) {
+    uint64_t tick = 0;
+    uint8_t status = 0; // running status
+    while (!track.AtEnd()) {
+        tick += track.Vlq();
+        uint8_t byte = track.U8();
+        if (byte & 0x80) {
+            status = byte;
+        } else if (status == 0) {
+            return false; // data with no status to run on
+        } else {
+            track.pos--; // first data byte of a running status message
+        }
+
+        if (status == 0xFF) {
+            // Meta event
+            uint8_t type = track.U8();
+            uint32_t length = track.Vlq();
+            if (type == 0x51 && length == 3) {
+                uint32_t usPerQuarter = (uint32_t)track.U8() << 16;
+                usPerQuarter |= track.U16();
+                if (usPerQuarter > 0) {
+                    tempos->push_back({ tick, usPerQuarter });
+                }
+            } else if (type == 0x2F) {
+                break; // end of track
+            } else {
+                track.Skip(length);
+            }
+            status = 0; // meta and sysex events cancel running status
+        } else if (status == 0xF0 || status == 0xF7) {
+            track.Skip(track.Vlq());
+            status = 0;
+        } else if (status >= 0xF0) {
+            return false; // system messages don't belong in a file
+        } else {
+            // Channel message, all but program change and channel pressure
+            // have two data bytes
+            uint8_t kind = status & 0xF0;
+            uint8_t data1 = track.U8() & 0x7F;
+            uint8_t data2 = (kind == 0xC0 || kind == 0xD0 ? 0 : track.U8() & 0x7F);
+            bool noteOn = (kind == 0x90 && data2 > 0);
+            bool noteOff = (kind == 0x80 || (kind == 0x90 && data2 == 0));
+            if ((noteOn || noteOff) && data1 >= MIDI_NOTE_A0 && data1 < MIDI_NOTE_A0 + NUM_KEYS) {
+                notes->push_back({ tick, (uint8_t)(data1 - MIDI_NOTE_A0), (uint8_t)(noteOn ? data2 : 0) });
+            }
+        }
+        if (!track.ok) {
+            return false;
+        }
+    }
+    return track.ok;
+}
+
+bool LoadMidiFile(const char* path, float sampleRateHz, std::vector<SongEvent>* events) {
+    events->clear();
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        SDL_Log("Could not open %s", path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[4096];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    fclose(file);
+
+    // Header chunk
+    MidiReader reader{ bytes.data(), bytes.size() };
+    uint32_t id = reader.U32();
+    uint32_t headerBytes = reader.U32();
+    uint32_t format = reader.U16();
+    uint32_t numTracks = reader.U16();
+    uint32_t division = reader.U16();
+    if (!reader.ok || id != 0x4D546864 || headerBytes < 6) { // "MThd"
+        SDL_Log("%s is not a MIDI file", path);
+        return false;
+    }
+    if (format > 1) {
+        SDL_Log("%s: only MIDI file types 0 and 1 are supported, not %u", path, format);
+        return false;
+    }
+    reader.Skip(headerBytes - 6);
+
+    // Track chunks, anything else is skipped
+    std::vector<TickEvent> notes;
+    std::vector<TempoChange> tempos;
+    uint32_t tracksRead = 0;
+    while (tracksRead < numTracks && !reader.AtEnd()) {
+        uint32_t chunkId = reader.U32();
+        uint32_t chunkBytes = reader.U32();
+        if (!reader.ok || chunkBytes > reader.size - reader.pos) {
+            break;
+        }
+        if (chunkId == 0x4D54726B) { // "MTrk"
+            // Each track's notes are appended in order, so a stable sort
+            // keeps same-tick events in file order, track by track
+            if (!ReadTrack(MidiReader{ reader.data + reader.pos, chunkBytes }, &notes, &tempos)) {
+                SDL_Log("%s: track %u is malformed", path, tracksRead + 1);
+                return false;
+            }
+            tracksRead++;
+        }
+        reader.Skip(chunkBytes);
+    }
+    if (tracksRead < numTracks) {
+        SDL_Log("%s: file ends after %u of %u tracks", path, tracksRead, numTracks);
+        return false;
+    }
+    std::stable_sort(notes.begin(), notes.end(), [](const TickEvent& a, const TickEvent& b) {
+        return a.tick < b.tick;
+    });
+    std::stable_sort(tempos.begin(), tempos.end(), [](const TempoChange& a, const TempoChange& b) {
+        return a.tick < b.tick;
+    });
+
+    // Ticks to seconds. Musical time is ticks per quarter note, scaled by
+    // the tempo in effect. SMPTE time is ticks per frame of a fixed frame
+    // rate, which tempo doesn't change.
+    bool smpte = (division & 0x8000) != 0;
+    double secPerTick = 0.0;
+    if (smpte) {
+        int framesPerSec = -(int)(int8_t)(division >> 8);
+        uint32_t ticksPerFrame = division & 0xFF;
+        if (framesPerSec <= 0 || ticksPerFrame == 0) {
+            SDL_Log("%s: bad time division", path);
+            return false;
+        }
+        secPerTick = 1.0 / ((double)framesPerSec * ticksPerFrame);
+        tempos.clear();
+    } else if (division == 0) {
+        SDL_Log("%s: bad time division", path);
+        return false;
+    }
+    auto TempoSecPerTick = [division](uint32_t usPerQuarter) {
+        return (double)usPerQuarter / 1e6 / (double)division;
+    };
+    if (!smpte) {
+        secPerTick = TempoSecPerTick(DEFAULT_US_PER_QUARTER);
+    }
+
+    events->reserve(notes.size());
+    std::bitset<NUM_KEYS> held;
+    size_t nextTempo = 0;
+    uint64_t segmentTick = 0; // where the current tempo took over
+    double segmentSec = 0.0;
+    auto ToFrame = [&](uint64_t tick) {
+        while (nextTempo < tempos.size() && tempos[nextTempo].tick <= tick) {
+            segmentSec += (double)(tempos[nextTempo].tick - segmentTick) * secPerTick;
+            segmentTick = tempos[nextTempo].tick;
+            secPerTick = TempoSecPerTick(tempos[nextTempo].usPerQuarter);
+            nextTempo++;
+        }
+        double sec = segmentSec + (double)(tick - segmentTick) * secPerTick;
+        return (uint64_t)llround(sec * (double)sampleRateHz);
+    };
+    for (const TickEvent& note : notes) {
+        bool on = (note.velocity > 0);
+        if (!on && !held[note.note]) {
+            continue; // nothing to release
+        }
+        held[note.note] = on;
+        events->push_back({ ToFrame(note.tick), (float)note.velocity / 127.f, note.note, on });
+    }
+
+    // Release whatever the song leaves held
+    uint64_t endFrame = (events->empty() ? 0 : events->back().frame);
+    for (uint8_t note = 0; note < NUM_KEYS; note++) {
+        if (held[note]) {
+            events->push_back({ endFrame, 0.f, note, false });
+        }
+    }
+    return true;
+}
+
+//-----------------------
+// MidiPlayer
+//-----------------------
+
+bool MidiPlayer::Load(const char* path, float sampleRateHz) {
+    if (!LoadMidiFile(path, sampleRateHz, &_events)) {
+        return false;
+    }
+    _lengthMs = (_events.empty() ? 0.0 : (double)_events.back().frame * 1000.0 / sampleRateHz);
+    _next = 0;
+    _position = 0;
+    SDL_Log("Loaded %s: %zu note events, %.1f s", path, _events.size(), _lengthMs / 1000.0);
+    return true;
+}
+
+size_t MidiPlayer::Play(VoicePool* voices, size_t maxFrames) {
+    while (_next < _events.size() && _events[_next].frame <= _position) {
+        const SongEvent& event = _events[_next++];
+        if (event.on) {
+            voices->NoteOn(event.note, event.velocity);
+        } else {
+            voices->NoteOff(event.note);
+        }
+    }
+    size_t frames = maxFrames;
+    if (_next < _events.size()) {
+        frames = (size_t)std::min<uint64_t>(frames, _events[_next].frame - _position);
+    }
+    _position += frames;
+    return frames;
+}
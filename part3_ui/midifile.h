@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class VoicePool;
+
+// A note on or off in a song, at its position in engine frames
+struct SongEvent {
+    uint64_t frame; // from the start of the song
+    float velocity; // 0 to 1, note on only
+    uint8_t note; // 0-based on the 88-key piano
+    bool on;
+};
+
+// Read a Standard MIDI File, type 0 or 1, into a flat list of note events
+// sorted by time, tempo changes already applied. Notes of every channel
+// are played, those off the piano are dropped, and notes still held at
+// the end are released there. False, with a log message, if the file
+// can't be read.
+bool LoadMidiFile(const char* path, float sampleRateHz, std::vector<SongEvent>* events);
+
+// Plays a song into the voices, on the exact frame of each event. All the
+// work is done by LoadMidiFile(): playing just walks a cursor along the
+// events, so it doesn't allocate or search. Starts with the first block
+// rendered, and plays once.
+class MidiPlayer {
+public:
+    // Main thread, before audio starts, at the engine rate
+    bool Load(const char* path, float sampleRateHz);
+
+    bool Loaded() const { return !_events.empty(); }
+    double LengthMs() const { return _lengthMs; }
+
+    // Audio thread. Play the events due now, then return how many frames,
+    // up to maxFrames, there are until the next one. The caller renders
+    // that many before calling again.
+    size_t Play(VoicePool* voices, size_t maxFrames);
+
+private:
+    std::vector<SongEvent> _events;
+    double _lengthMs = 0.0;
+    size_t _next = 0; // first event not played yet
+    uint64_t _position = 0; // frames played
+};
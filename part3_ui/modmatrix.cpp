@@ -0,0 +1,165 @@
+#include "modmatrix.h"
+#include "constants.h"
+#include "voice.h"
+#include "utility.h"
+#include <math.h>
+
+namespace mod {
+
+const char* SourceName(Source source) {
+    switch (source) {
+        case Source::Lfo1: return "LFO 1";
+        case Source::Lfo2: return "LFO 2";
+        case Source::Envelope: return "Env";
+        case Source::Velocity: return "Vel";
+        case Source::Key: return "Key";
+    }
+    return "";
+}
+
+const char* DestName(Dest dest) {
+    switch (dest) {
+        case Dest::Volume: return "Level";
+        case Dest::Pan: return "Pan";
+        case Dest::CoarsePitch: return "Pitch";
+        case Dest::FinePitch: return "Fine";
+    }
+    return "";
+}
+
+const char* LfoShapeName(LfoShape shape) {
+    switch (shape) {
+        case LfoShape::Sine: return "Sine";
+        case LfoShape::Triangle: return "Tri";
+        case LfoShape::Saw: return "Saw";
+        case LfoShape::Square: return "Square";
+    }
+    return "";
+}
+
+bool IsPerVoice(Source source) {
+    return (source != Source::Lfo1 && source != Source::Lfo2);
+}
+
+Matrix::Matrix() {
+    // An empty table is also where the LFOs' defaults live until the
+    // first Publish()
+    Settings settings;
+    _initial.lfos = settings.lfos;
+}
+
+Matrix::~Matrix() {
+    delete _pending.load();
+    if (_current != &_initial) {
+        delete _current;
+    }
+    Table* table = nullptr;
+    while (_retired.TryPop(&table)) {
+        delete table;
+    }
+}
+
+void Matrix::Publish(const Settings& settings) {
+    Table* table = nullptr;
+    while (_retired.TryPop(&table)) {
+        delete table;
+    }
+
+    table = new Table();
+    Compile(settings, table);
+
+    // Only the audio thread takes tables out of _pending, so one that's
+    // still here was never seen by it
+    delete _pending.exchange(table, std::memory_order_acq_rel);
+}
+
+void Matrix::Compile(const Settings& settings, Table* table) {
+    *table = Table();
+    table->sequence = ++_compiled;
+    for (size_t l = 0; l < NUM_LFOS; l++) {
+        table->lfos[l].shape = settings.lfos[l].shape;
+        table->lfos[l].rateHz = utility::Clamp(settings.lfos[l].rateHz, MIN_LFO_RATE_HZ, MAX_LFO_RATE_HZ);
+    }
+
+    // Global routes first, then per voice, so each walk is one loop
+    // without checking the source's kind
+    for (bool perVoice : { false, true }) {
+        for (const Route& route : settings.routes) {
+            if (route.amount == 0.f || IsPerVoice(route.source) != perVoice) {
+                continue;
+            }
+            if (perVoice && route.dest == Dest::Pan) {
+                continue; // see Dest
+            }
+            table->entries[table->numRoutes++] = { route.source, (uint8_t)route.dest, route.amount };
+        }
+        if (!perVoice) {
+            table->numGlobal = table->numRoutes;
+        }
+    }
+}
+
+void Matrix::Load(const Table& table) {
+    if (table.sequence > _current->sequence) {
+        *_current = table;
+    }
+}
+
+float Matrix::LfoValue(LfoShape shape, float phase) {
+    switch (shape) {
+        case LfoShape::Sine: return sinf(TWOPI * phase);
+        case LfoShape::Triangle: return 1.f - 4.f * fabsf(phase - 0.5f);
+        case LfoShape::Saw: return 2.f * phase - 1.f;
+        case LfoShape::Square: return (phase < 0.5f ? 1.f : -1.f);
+    }
+    return 0.f;
+}
+
+void Matrix::Process(float sampleRateHz, size_t frames) {
+    // Swap only when the old table can be handed back. Publish() drains
+    // _retired every time, so it only fills up if the UI stalls.
+    if (_pending.load(std::memory_order_relaxed) != nullptr && !_retired.Full()) {
+        Table* next = _pending.exchange(nullptr, std::memory_order_acq_rel);
+        if (next != nullptr && next->sequence < _current->sequence) {
+            _retired.TryPush(next); // overtaken by a Load()
+        } else if (next != nullptr) {
+            if (_current != &_initial) {
+                _retired.TryPush(_current);
+            }
+            _current = next;
+        }
+    }
+    const Table& table = *_current;
+
+    std::array<float, NUM_LFOS> lfos;
+    for (size_t l = 0; l < NUM_LFOS; l++) {
+        lfos[l] = LfoValue(table.lfos[l].shape, _lfoPhases[l]);
+        float phase = _lfoPhases[l] + table.lfos[l].rateHz * (float)frames / sampleRateHz;
+        _lfoPhases[l] = phase - floorf(phase);
+    }
+
+    _global = {};
+    for (size_t i = 0; i < table.numGlobal; i++) {
+        const Table::Entry& entry = table.entries[i];
+        _global[entry.dest] += entry.amount * lfos[(size_t)entry.source];
+    }
+}
+
+Offsets Matrix::ForVoice(const Voice& voice) const {
+    const Table& table = *_current;
+    Offsets offsets = {};
+    for (size_t i = table.numGlobal; i < table.numRoutes; i++) {
+        const Table::Entry& entry = table.entries[i];
+        float value = 0.f;
+        switch (entry.source) {
+            case Source::Envelope: value = voice.env.Level(); break;
+            case Source::Velocity: value = voice.velocity; break;
+            case Source::Key: value = 2.f * (float)voice.note / (float)(NUM_KEYS - 1) - 1.f; break;
+            default: break;
+        }
+        offsets[entry.dest] += entry.amount * value;
+    }
+    return offsets;
+}
+
+} // namespace mod
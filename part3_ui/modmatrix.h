@@ -0,0 +1,135 @@
+#pragma once
+
+#include "spsc_queue.h"
+#include <atomic>
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+struct Voice;
+
+// Modulation: LFOs and per-voice sources routed to oscillator parameters.
+// The UI edits plain Settings and publishes them. They're compiled into
+// a compact Table on the UI thread and swapped in atomically, so the
+// audio thread only ever walks a short list of live routes once per
+// block, and never allocates or locks.
+namespace mod {
+
+enum class Source : uint8_t {
+    Lfo1, // global, [-1, 1]
+    Lfo2,
+    Envelope, // per voice, amplitude envelope level, [0, 1]
+    Velocity, // per voice, [0, 1]
+    Key, // per voice, [-1, 1] from the lowest key to the highest
+};
+constexpr uint32_t NUM_SOURCES = 5;
+constexpr uint32_t NUM_LFOS = 2;
+
+// Oscillator parameters. A route adds amount * source to the knob, where
+// an amount of 1 sweeps the knob's whole range. Pan is applied after the
+// voices are mixed, so it only follows global sources.
+enum class Dest : uint8_t {
+    Volume,
+    Pan,
+    CoarsePitch,
+    FinePitch,
+};
+constexpr uint32_t NUM_DESTS = 4;
+
+enum class LfoShape : uint8_t {
+    Sine,
+    Triangle,
+    Saw,
+    Square,
+};
+constexpr uint32_t NUM_LFO_SHAPES = 4;
+
+constexpr float MIN_LFO_RATE_HZ = 0.05f;
+constexpr float MAX_LFO_RATE_HZ = 20.f;
+
+const char* SourceName(Source source);
+const char* DestName(Dest dest);
+const char* LfoShapeName(LfoShape shape);
+bool IsPerVoice(Source source);
+
+struct Lfo {
+    LfoShape shape = LfoShape::Sine;
+    float rateHz = 1.f;
+};
+
+struct Route {
+    Source source = Source::Lfo1;
+    Dest dest = Dest::Volume;
+    float amount = 0.f; // range [-1, 1], 0 is unused
+};
+
+// Everything the user edits
+struct Settings {
+    static constexpr size_t MAX_ROUTES = 8;
+    std::array<Lfo, NUM_LFOS> lfos;
+    std::array<Route, MAX_ROUTES> routes;
+};
+
+// Summed modulation of each destination, in knob ranges
+using Offsets = std::array<float, NUM_DESTS>;
+
+class Matrix {
+public:
+    // Live routes only, global sources first
+    struct Table {
+        struct Entry {
+            Source source;
+            uint8_t dest;
+            float amount;
+        };
+        std::array<Lfo, NUM_LFOS> lfos;
+        std::array<Entry, Settings::MAX_ROUTES> entries;
+        uint8_t numGlobal = 0;
+        uint8_t numRoutes = 0;
+        uint64_t sequence = 0; // order compiled in, the newest table wins
+    };
+
+    Matrix();
+    ~Matrix();
+
+    // UI thread. Compile settings into a new table for the audio thread
+    // to pick up at its next block. Also frees tables it's done with.
+    void Publish(const Settings& settings);
+
+    // UI thread. Compile settings into table, for a caller that hands it
+    // to the audio thread another way (see PatchSwap).
+    void Compile(const Settings& settings, Table* table);
+
+    // Audio thread, between blocks. Switch to a copy of table, unless a
+    // table compiled after it is already in use.
+    void Load(const Table& table);
+
+    // Audio thread, once per block before any voice is rendered. Swaps in
+    // the latest table, and evaluates the LFOs at the start of the block.
+    void Process(float sampleRateHz, size_t frames);
+
+    // Audio thread and workers, during the block
+    const Offsets& Global() const { return _global; }
+    bool HasVoiceRoutes() const { return _current->numRoutes > _current->numGlobal; }
+    Offsets ForVoice(const Voice& voice) const;
+
+private:
+    static float LfoValue(LfoShape shape, float phase);
+
+    Table _initial; // no routes, never freed
+    Table* _current = &_initial;
+    uint64_t _compiled = 0; // UI thread, tables compiled so far
+
+    // UI -> audio: the newest table not yet picked up. Publishing again
+    // before that replaces it.
+    std::atomic<Table*> _pending{nullptr};
+
+    // Audio -> UI: tables swapped out, freed on the next Publish()
+    SpscQueue<Table*, 16> _retired;
+
+    // Audio thread state
+    std::array<float, NUM_LFOS> _lfoPhases = {}; // cycles, [0, 1)
+    Offsets _global = {};
+};
+
+} // namespace mod
@@ -1,8 +1,11 @@
 #include "oscillator.h"
 #include "utility.h"
+#include "synth.h"
+#include "trace.h"
 #include <math.h>
 #include <stdlib.h>
 #include <SDL.h>
+#include <algorithm>
 
 namespace oscillator {
 
@@ -31,48 +34,549 @@ float Whitenoise(float phase) {
     return utility::Map((float)rand(), 0.f, (float)RAND_MAX, -1.f, 1.f);
 }
 
+float Silence(float phase) {
+    // phase unused
+    return 0.f;
+}
+
 } // namespace oscillator
 
 bool Oscillator::Init(Synth* synth) {
     _synth = synth;
-    return true;
+
+    uint32_t startMs = SDL_GetTicks();
+    for (size_t i = 0; i < _sources.size(); i++) {
+        if (_sources[i].periodic) {
+            _wavetables[i].Build(_sources[i].fn, _synth->sampleRateHz);
+        }
+    }
+    SDL_Log("Built wavetables in %u ms", SDL_GetTicks() - startMs);
+
+    for (uint8_t note = 0; note < NUM_KEYS; note++) {
+        _noteFrequencies[note] = GetFrequency(note, 0.f);
+    }
+
+    // Start settled at the initial control values
+    float sampleRateHz = _synth->sampleRateHz;
+    _gainLeft.Init(SmoothedParam::Mode::Linear, GAIN_SMOOTHING_MS, 0.f, sampleRateHz);
+    _gainRight.Init(SmoothedParam::Mode::Linear, GAIN_SMOOTHING_MS, 0.f, sampleRateHz);
+    _pitchCents.Init(SmoothedParam::Mode::OnePole, PITCH_SMOOTHING_MS, 0.f, sampleRateHz);
+    _cutoffOctaves.Init(SmoothedParam::Mode::OnePole, CUTOFF_SMOOTHING_MS, 0.f, sampleRateHz);
+    _lastVolume = -1.f; // force gains to be computed
+    _lastCutoffHz = -1.f;
+    UpdateControls(0);
+    _gainLeft.Init(SmoothedParam::Mode::Linear, GAIN_SMOOTHING_MS, _gainLeft.Target(), sampleRateHz);
+    _gainRight.Init(SmoothedParam::Mode::Linear, GAIN_SMOOTHING_MS, _gainRight.Target(), sampleRateHz);
+    _pitchCents.Init(SmoothedParam::Mode::OnePole, PITCH_SMOOTHING_MS, _pitchCents.Target(), sampleRateHz);
+    _pitchRatio = powf(2.f, _pitchCents.Current() / 1200.f);
+    _cutoffOctaves.Init(SmoothedParam::Mode::OnePole, CUTOFF_SMOOTHING_MS, _cutoffOctaves.Target(), sampleRateHz);
+    _cutoffHz = filter::MIN_CUTOFF_HZ * exp2f(_cutoffOctaves.Current());
+    _lastDrive = _params.drive;
+    _wideBuffers.resize(MAX_TASKS);
+    _mix.resize(MAX_RENDER_FRAMES);
+    _mixRight.resize(MAX_RENDER_FRAMES);
+    _lastUnison = 0; // force the unison tables to be computed
+    UpdateUnison();
+    return _oversampler.Init(BLOCK_FRAMES) && _oversamplerRight.Init(BLOCK_FRAMES);
+}
+
+uint32_t Oscillator::PrevSource(uint32_t index) {
+    return (index == 0 ? NumSources() - 1 : index - 1);
+}
+
+uint32_t Oscillator::NextSource(uint32_t index) {
+    return (index + 1) % NumSources();
 }
 
-void Oscillator::Prev() {
-    _sourceIndex = (_sourceIndex == 0 ? _sources.size() - 1: _sourceIndex - 1);
+void Oscillator::SetParam(Event::Param param, float value, uint32_t oscillator) {
+    BankOscillatorParams& bank = _params.bank[std::min(oscillator, NUM_OSCILLATORS - 1)];
+    switch (param) {
+        case Event::Param::Volume: _params.volume = value; break;
+        case Event::Param::Pan: _params.pan = value; break;
+        case Event::Param::CoarsePitch: _params.coarsePitch = value; break;
+        case Event::Param::FinePitch: _params.finePitch = value; break;
+        case Event::Param::Drive: _params.drive = value; break;
+        case Event::Param::Oversampling:
+            if (Oversampler::IsValidFactor((uint32_t)value)) {
+                _params.oversampling = (uint32_t)value;
+            }
+            break;
+        case Event::Param::FilterType: _params.filterType = std::min((uint32_t)value, filter::NUM_TYPES - 1); break;
+        case Event::Param::FilterCutoff: _params.cutoffHz = value; break;
+        case Event::Param::FilterResonance: _params.resonance = value; break;
+        case Event::Param::Attack: _params.envelope.attackMs = value; break;
+        case Event::Param::Decay: _params.envelope.decayMs = value; break;
+        case Event::Param::Sustain: _params.envelope.sustain = value; break;
+        case Event::Param::Release: _params.envelope.releaseMs = value; break;
+        case Event::Param::Unison: _params.unison = (uint32_t)utility::Clamp(value, 1.f, (float)MAX_UNISON); break;
+        case Event::Param::Detune: _params.detune = value; break;
+        case Event::Param::Spread: _params.spread = value; break;
+        case Event::Param::OscMix: bank.mix = value; break;
+        case Event::Param::OscCoarse: bank.coarse = value; break;
+        case Event::Param::OscFine: bank.fine = value; break;
+    }
 }
 
-void Oscillator::Next() {
-    _sourceIndex = (_sourceIndex + 1) % _sources.size();
+void Oscillator::SetSource(uint32_t index, uint32_t oscillator) {
+    if (index < NumSources() && oscillator < NUM_OSCILLATORS) {
+        _params.bank[oscillator].sourceIndex = index;
+    }
+}
+
+void Oscillator::SetParams(const OscillatorParams& params) {
+    _params = params;
+    _params.filterType = std::min(_params.filterType, filter::NUM_TYPES - 1);
+    if (!Oversampler::IsValidFactor(_params.oversampling)) {
+        _params.oversampling = 1;
+    }
+    for (BankOscillatorParams& bank : _params.bank) {
+        if (bank.sourceIndex >= NumSources()) {
+            bank.sourceIndex = 0;
+        }
+    }
 }
 
 // See this page for converting notes -> cents -> frequency
 // https://en.wikipedia.org/wiki/Cent_(music)
-float Oscillator::GetFrequency() const {
-    float cents = noteIndex * 100.0f;
-    cents += (round(coarsePitch) * 100.0f);
-    cents += finePitch;
-    return A0Freq * pow(2.f, cents / 1200.f);
+float Oscillator::GetFrequency(uint8_t note, float pitchCents) {
+    float cents = note * 100.0f + pitchCents;
+    return A0Freq * powf(2.f, cents / 1200.f);
+}
+
+void Oscillator::UpdateControls(size_t frames) {
+    // Global modulation moves the knobs for this block, then the result
+    // is smoothed like any knob change
+    const mod::Offsets& mods = _synth->mod.Global();
+    float newVolume = utility::Clamp(_params.volume + mods[(size_t)mod::Dest::Volume], 0.f, 1.f);
+    float newPan = utility::Clamp(_params.pan + mods[(size_t)mod::Dest::Pan], -.5f, .5f);
+    _volume = newVolume;
+    if (newVolume != _lastVolume || newPan != _lastPan) {
+        _lastVolume = newVolume;
+        _lastPan = newPan;
+
+        // Constant power panning
+        float theta = utility::Map(newPan, -.5f, .5f, 0.f, (float)M_PI / 2.f);
+        _gainLeft.SetTarget(newVolume * cosf(theta));
+        _gainRight.SetTarget(newVolume * sinf(theta));
+    }
+
+    // Pitch is applied per block, so it is smoothed at block rate
+    _coarsePitch = _params.coarsePitch + COARSE_RANGE_SEMITONES * mods[(size_t)mod::Dest::CoarsePitch];
+    float fineCents = _params.finePitch + FINE_RANGE_CENTS * mods[(size_t)mod::Dest::FinePitch];
+    _pitchCents.SetTarget(roundf(_coarsePitch) * 100.0f + fineCents);
+    if (_pitchCents.IsSmoothing()) {
+        float cents = _pitchCents.Skip(frames);
+        _pitchRatio = powf(2.f, cents / 1200.f);
+    }
+
+    // Cutoff too, in octaves so sweeps sound even
+    if (_params.cutoffHz != _lastCutoffHz) {
+        _lastCutoffHz = _params.cutoffHz;
+        float cutoffHz = utility::Clamp(_lastCutoffHz, filter::MIN_CUTOFF_HZ, filter::MAX_CUTOFF_HZ);
+        _cutoffOctaves.SetTarget(log2f(cutoffHz / filter::MIN_CUTOFF_HZ));
+    }
+    if (_cutoffOctaves.IsSmoothing()) {
+        _cutoffHz = filter::MIN_CUTOFF_HZ * exp2f(_cutoffOctaves.Skip(frames));
+    }
+
+    _envelopeRates.Update(_params.envelope, _synth->sampleRateHz, frames);
+    UpdateUnison();
+}
+
+void Oscillator::UpdateUnison() {
+    uint32_t unison = std::min(std::max(_params.unison, 1u), MAX_UNISON);
+    float detune = utility::Clamp(_params.detune, 0.f, 1.f);
+    float spread = utility::Clamp(_params.spread, 0.f, 1.f);
+    if (unison == _lastUnison && detune == _lastDetune && spread == _lastSpread) {
+        return;
+    }
+    _lastUnison = unison;
+    _lastDetune = detune;
+    _lastSpread = spread;
+
+    // Constant power panning like the mono path, scaled so a copy in the
+    // middle has unity gain on both sides, before the global pan
+    float norm = sqrtf(2.f / (float)unison);
+    for (uint32_t c = 0; c < MAX_UNISON; c++) {
+        if (c >= unison) {
+            _unisonRatios[c] = 1.f;
+            _unisonGainLeft[c] = 0.f;
+            _unisonGainRight[c] = 0.f;
+            continue;
+        }
+        // Evenly spaced copies all come back into phase every few seconds,
+        // a slow pulse, so the inner ones are nudged off the grid by
+        // uneven amounts. Where they land is fixed, renders repeat.
+        float slot = (float)c;
+        if (c > 0 && c + 1 < unison) {
+            float golden = (float)(c + 1) * 0.618034f;
+            slot += UNISON_JITTER * (golden - floorf(golden) - 0.5f);
+        }
+        float position = (unison == 1 ? 0.f : utility::Map(slot, 0.f, (float)(unison - 1), -1.f, 1.f));
+        float cents = position * detune * MAX_DETUNE_CENTS / 2.f;
+        float theta = (1.f + position * spread) * (float)M_PI / 4.f;
+        _unisonRatios[c] = exp2f(cents / 1200.f);
+        _unisonGainLeft[c] = norm * cosf(theta);
+        _unisonGainRight[c] = norm * sinf(theta);
+    }
+}
+
+// Coarse pitch is rounded after the voice's offset is added, so it still
+// moves in whole semitones
+float Oscillator::VoicePitchRatio(const mod::Offsets& offsets) const {
+    float coarse = COARSE_RANGE_SEMITONES * offsets[(size_t)mod::Dest::CoarsePitch];
+    float fine = FINE_RANGE_CENTS * offsets[(size_t)mod::Dest::FinePitch];
+    float cents = (roundf(_coarsePitch + coarse) - roundf(_coarsePitch)) * 100.f + fine;
+    return (cents == 0.f ? 1.f : exp2f(cents / 1200.f));
+}
+
+// Relative to the global volume, which is applied after the mix
+float Oscillator::VoiceGain(const mod::Offsets& offsets) const {
+    if (_volume <= 0.f) {
+        return 1.f;
+    }
+    return utility::Clamp(_volume + offsets[(size_t)mod::Dest::Volume], 0.f, 1.f) / _volume;
+}
+
+void Oscillator::RenderTask(void* context, size_t task) {
+    TRACE_ZONE("Oscillator::RenderTask");
+    Oscillator* osc = (Oscillator*)context;
+    if (osc->_block.unison > 1) {
+        if (osc->_block.factor == 1) {
+            osc->RenderUnisonVoices(osc->_taskBuffers[task], task);
+        } else {
+            osc->RenderUnisonVoices(osc->_wideBuffers[task], task);
+        }
+    } else if (osc->_block.factor == 1) {
+        osc->RenderVoices(osc->_taskBuffers[task], task);
+    } else {
+        osc->RenderVoices(osc->_wideBuffers[task], task);
+    }
+}
+
+template <typename Buffers>
+void Oscillator::RenderVoices(Buffers& buffers, size_t task) {
+    const Block block = _block;
+    float pitchRatio = _pitchRatio;
+    VoicePool& voices = _synth->voices;
+
+    size_t begin = task * VOICES_PER_TASK;
+    size_t count = std::min(voices.NumActive(), begin + VOICES_PER_TASK) - begin;
+    bool filtered = (block.filterType != filter::Type::Off);
+    filter::FilterGroup filters(block.filterType, block.renderRateHz);
+    std::array<float, VOICES_PER_TASK> envStart;
+    std::array<float, VOICES_PER_TASK> envEnd;
+    for (size_t l = 0; l < count; l++) {
+        // Unfiltered, the first voice is rendered straight into the sum
+        // and the others are added to it as they go
+        float* out = buffers.voices[l].data();
+        if (!filtered) {
+            out = (l == 0 ? buffers.sum.data() : buffers.voices[0].data());
+        }
+        Voice& voice = voices.Active(begin + l);
+        float voicePitchRatio = 1.f;
+        float modGain = 1.f;
+        if (block.voiceMods) {
+            mod::Offsets offsets = _synth->mod.ForVoice(voice);
+            voicePitchRatio = VoicePitchRatio(offsets);
+            modGain = VoiceGain(offsets);
+        }
+        float freq = _noteFrequencies[voice.note] * pitchRatio * voicePitchRatio;
+        RenderBank(block, voice, freq, out, buffers.scratch.data());
+
+        envStart[l] = voice.env.Level() * voice.modGain;
+        envEnd[l] = voice.env.Advance(_envelopeRates) * modGain;
+        voice.modGain = modGain;
+        if (voice.stealing) {
+            FadeStolen(block, voice, envStart[l], envEnd[l]);
+        }
+        if (filtered) {
+            filters.Add(&voice.filter, block.cutoffHz, block.resonance);
+            continue;
+        }
+        DriveVoice(block, out);
+        if (l == 0) {
+            kernels::Ramp(out, out, envStart[l], envEnd[l], block.frames);
+        } else {
+            kernels::AddRamp(out, buffers.sum.data(), envStart[l], envEnd[l], block.frames);
+        }
+    }
+
+    // The envelope comes after the filter, so it doesn't change how the
+    // filter responds
+    if (filtered && count > 0) {
+        filters.Process(buffers.voices[0].data(), buffers.voices[0].size(), block.frames);
+        for (size_t l = 0; l < count; l++) {
+            DriveVoice(block, buffers.voices[l].data());
+        }
+        kernels::Ramp(buffers.voices[0].data(), buffers.sum.data(), envStart[0], envEnd[0], block.frames);
+        for (size_t l = 1; l < count; l++) {
+            kernels::AddRamp(buffers.voices[l].data(), buffers.sum.data(), envStart[l], envEnd[l], block.frames);
+        }
+    }
+}
+
+// Voices are never rendered straight into the sum here, each copy is
+// added to its voice
+template <typename Buffers>
+void Oscillator::RenderUnisonVoices(Buffers& buffers, size_t task) {
+    const Block block = _block;
+    float pitchRatio = _pitchRatio;
+    VoicePool& voices = _synth->voices;
+
+    size_t begin = task * VOICES_PER_TASK;
+    size_t count = std::min(voices.NumActive(), begin + VOICES_PER_TASK) - begin;
+    bool filtered = (block.filterType != filter::Type::Off);
+    filter::FilterGroup filtersLeft(block.filterType, block.renderRateHz);
+    filter::FilterGroup filtersRight(block.filterType, block.renderRateHz);
+    std::array<float, VOICES_PER_TASK> envStart;
+    std::array<float, VOICES_PER_TASK> envEnd;
+    for (size_t l = 0; l < count; l++) {
+        float* outLeft = buffers.voices[l].data();
+        float* outRight = buffers.voicesRight[l].data();
+
+        Voice& voice = voices.Active(begin + l);
+        float voicePitchRatio = 1.f;
+        float modGain = 1.f;
+        if (block.voiceMods) {
+            mod::Offsets offsets = _synth->mod.ForVoice(voice);
+            voicePitchRatio = VoicePitchRatio(offsets);
+            modGain = VoiceGain(offsets);
+        }
+
+        float freq = _noteFrequencies[voice.note] * pitchRatio * voicePitchRatio;
+        RenderBankUnison(block, voice, freq, outLeft, outRight, buffers.scratch.data());
+
+        envStart[l] = voice.env.Level() * voice.modGain;
+        envEnd[l] = voice.env.Advance(_envelopeRates) * modGain;
+        voice.modGain = modGain;
+        if (voice.stealing) {
+            FadeStolen(block, voice, envStart[l], envEnd[l]);
+        }
+        if (filtered) {
+            filtersLeft.Add(&voice.filter, block.cutoffHz, block.resonance);
+            filtersRight.Add(&voice.filterRight, block.cutoffHz, block.resonance);
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    if (filtered) {
+        filtersLeft.Process(buffers.voices[0].data(), buffers.voices[0].size(), block.frames);
+        filtersRight.Process(buffers.voicesRight[0].data(), buffers.voicesRight[0].size(), block.frames);
+    }
+    for (size_t l = 0; l < count; l++) {
+        DriveVoice(block, buffers.voices[l].data());
+        DriveVoice(block, buffers.voicesRight[l].data());
+    }
+    kernels::Ramp(buffers.voices[0].data(), buffers.sum.data(), envStart[0], envEnd[0], block.frames);
+    kernels::Ramp(buffers.voicesRight[0].data(), buffers.sumRight.data(), envStart[0], envEnd[0], block.frames);
+    for (size_t l = 1; l < count; l++) {
+        kernels::AddRamp(buffers.voices[l].data(), buffers.sum.data(), envStart[l], envEnd[l], block.frames);
+        kernels::AddRamp(buffers.voicesRight[l].data(), buffers.sumRight.data(), envStart[l], envEnd[l], block.frames);
+    }
 }
 
-void Oscillator::GetSample(float* left, float* right) {
-    float sample = _sources[_sourceIndex].fn(_phase);
+void Oscillator::DriveVoice(const Block& block, float* voice) {
+    if (block.driveStart > 0.f || block.driveEnd > 0.f) {
+        kernels::Saturate(voice, voice, DriveGain(block.driveStart), DriveGain(block.driveEnd),
+                block.driveStart, block.driveEnd, block.frames);
+    }
+}
 
-    // Update phase for next time
-    float dPhase = TWOPI * GetFrequency() / SAMPLE_RATE_HZ;
-    _phase = fmodf(_phase + dPhase, TWOPI);
+void Oscillator::FadeStolen(const Block& block, Voice& voice, float& gainStart, float& gainEnd) {
+    const float scale = 1.f / (float)VoicePool::STEAL_FADE_FRAMES;
+    size_t frames = std::min(block.frames / block.factor, (size_t)voice.stealFrames);
+    gainStart *= (float)voice.stealFrames * scale;
+    voice.stealFrames = (uint16_t)(voice.stealFrames - frames);
+    gainEnd *= (float)voice.stealFrames * scale;
+}
 
-    if (!noteActive) {
-        *left = 0.0f;
-        *right = 0.0f;
+// The first oscillator writes out, the rest add to it. OSC A alone at full
+// mix renders exactly as a single oscillator did.
+void Oscillator::RenderBank(const Block& block, Voice& voice, float freqHz, float* out, float* scratch) const {
+    if (block.numSlots == 0) {
+        std::fill(out, out + block.frames, 0.f);
         return;
     }
+    for (uint32_t s = 0; s < block.numSlots; s++) {
+        const Block::Slot& slot = block.slots[s];
+        bool first = (s == 0);
+        if (slot.source->periodic) {
+            // Tables are band-limited for the base rate, oversampling just
+            // steps through them more slowly
+            float freq = freqHz * slot.ratio;
+            uint32_t level = Wavetable::LevelForFrequency(freq);
+            uint32_t increment = slot.wavetable->PhaseIncrement(freq / (float)block.factor);
+            uint32_t* phase = &voice.phases[slot.index];
+            if (first) {
+                slot.wavetable->Render(level, block.interp, out, block.frames, phase, increment);
+            } else {
+                slot.wavetable->RenderAdd(level, block.interp, out, block.frames, phase, increment, slot.gain);
+            }
+        } else {
+            RenderSource(block, slot, voice, freqHz, (first ? out : scratch));
+            if (!first) {
+                kernels::AddRamp(scratch, out, slot.gain, slot.gain, block.frames);
+            }
+        }
+        if (first && slot.gain != 1.f) {
+            kernels::Gain(out, out, slot.gain, block.frames);
+        }
+    }
+}
+
+// Noise and samples have nothing to detune, they go to both sides once,
+// like a copy in the middle
+void Oscillator::RenderBankUnison(
+        const Block& block, Voice& voice, float freqHz, float* left, float* right, float* scratch) const {
+    std::fill(left, left + block.frames, 0.f);
+    std::fill(right, right + block.frames, 0.f);
+    for (uint32_t s = 0; s < block.numSlots; s++) {
+        const Block::Slot& slot = block.slots[s];
+        if (!slot.source->periodic) {
+            RenderSource(block, slot, voice, freqHz, scratch);
+            kernels::AddRamp(scratch, left, slot.gain, slot.gain, block.frames);
+            kernels::AddRamp(scratch, right, slot.gain, slot.gain, block.frames);
+            continue;
+        }
+
+        // Every copy plays from the level of the highest one, so none of
+        // them alias
+        float freq = freqHz * slot.ratio;
+        uint32_t level = Wavetable::LevelForFrequency(freq * _unisonRatios[block.unison - 1]);
+        std::array<uint32_t, MAX_UNISON>& phases = voice.unisonPhases[slot.index];
+        for (uint32_t first = 0; first < block.unison; first += kernels::UNISON_LANES) {
+            kernels::UnisonLanes lanes;
+            for (uint32_t c = 0; c < kernels::UNISON_LANES; c++) {
+                uint32_t copy = first + c;
+                bool used = (copy < block.unison);
+                lanes.phase[c] = (used ? phases[copy] : 0);
+                lanes.increment[c] = (used ? slot.wavetable->PhaseIncrement(freq * _unisonRatios[copy] / (float)block.factor) : 0);
+                lanes.gainLeft[c] = (used ? slot.gain * _unisonGainLeft[copy] : 0.f);
+                lanes.gainRight[c] = (used ? slot.gain * _unisonGainRight[copy] : 0.f);
+            }
+            slot.wavetable->RenderUnison(level, block.interp, &lanes, left, right, block.frames);
+            for (uint32_t c = 0; c < kernels::UNISON_LANES && first + c < block.unison; c++) {
+                phases[first + c] = lanes.phase[c];
+            }
+        }
+    }
+}
+
+void Oscillator::RenderSource(const Block& block, const Block::Slot& slot, Voice& voice, float freqHz, float* out) const {
+    if (slot.source->sampled) {
+        _synth->sampler.Render(voice, freqHz * slot.ratio, block.renderRateHz, out, block.frames);
+    } else {
+        kernels::Noise(&voice.noise, out, block.frames);
+    }
+}
+
+void Oscillator::Process(float* left, float* right, size_t frames) {
+    TRACE_ZONE("Oscillator::Process");
+    // Snapshot all controls once per block
+    _oversampler.SetFactor(_params.oversampling);
+    uint32_t factor = _oversampler.Factor();
+    size_t renderFrames = frames * factor;
+    bool anyPeriodic = false;
+    bool anySampled = false;
+    _block.numSlots = 0;
+    for (uint32_t o = 0; o < NUM_OSCILLATORS; o++) {
+        const BankOscillatorParams& bank = _params.bank[o];
+        float gain = utility::Clamp(bank.mix, 0.f, 1.f);
+        bool sampled = _sources[bank.sourceIndex].sampled;
+        if (gain <= 0.f || (sampled && anySampled)) {
+            continue; // a voice has one sample stream, the first sampler plays
+        }
+        anySampled = anySampled || sampled;
+        float semitones = roundf(utility::Clamp(bank.coarse, -MAX_BANK_SEMITONES, MAX_BANK_SEMITONES));
+        float cents = semitones * 100.f + utility::Clamp(bank.fine, -MAX_BANK_CENTS, MAX_BANK_CENTS);
+        Block::Slot& slot = _block.slots[_block.numSlots++];
+        slot.source = &_sources[bank.sourceIndex];
+        slot.wavetable = &_wavetables[bank.sourceIndex];
+        slot.index = o;
+        slot.ratio = (cents == 0.f ? 1.f : exp2f(cents / 1200.f));
+        slot.gain = gain;
+        anyPeriodic = anyPeriodic || slot.source->periodic;
+    }
+    _block.interp = interpolation;
+    _block.factor = factor;
+    _block.frames = renderFrames;
+    UpdateControls(frames);
+    _block.filterType = (filter::Type)_params.filterType;
+    _block.renderRateHz = _synth->sampleRateHz * (float)factor;
+    _block.cutoffHz = _cutoffHz;
+    _block.resonance = _params.resonance;
+    _block.voiceMods = _synth->mod.HasVoiceRoutes();
+    _block.driveStart = _lastDrive;
+    _block.driveEnd = _params.drive;
+    _lastDrive = _params.drive;
+    _block.unison = (anyPeriodic ? _lastUnison : 1);
+    bool stereo = (_block.unison > 1);
+    if (stereo && !_wasStereo) {
+        _oversamplerRight.Reset(); // holds whatever it had when unison went off
+    }
+    _wasStereo = stereo;
+    _oversamplerRight.SetFactor(factor);
 
-    *left = sample * volume;
-    *right = sample * volume;
+    // Sum all voices in mono, then pan once. With unison on, the voices
+    // are already stereo, and the pan only balances the two sides.
+    size_t numVoices = _synth->voices.NumActive();
+    size_t numTasks = (numVoices + VOICES_PER_TASK - 1) / VOICES_PER_TASK;
+    if (numVoices >= PARALLEL_MIN_VOICES) {
+        _synth->workers.Run(RenderTask, this, numTasks);
+    } else {
+        for (size_t task = 0; task < numTasks; task++) {
+            RenderTask(this, task);
+        }
+    }
 
-    // Constant power panning
-    float theta = utility::Map(pan, -.5f, .5f, 0.f, (float)M_PI / 2.f);
-    *left *= cos(theta);
-    *right *= sin(theta);
+    float* mix = (factor == 1 ? left : _mix.data());
+    float* mixRight = (factor == 1 ? right : _mixRight.data());
+    for (size_t task = 0; task < numTasks; task++) {
+        const float* sum = (factor == 1 ? _taskBuffers[task].sum.data() : _wideBuffers[task].sum.data());
+        const float* sumRight = (factor == 1 ? _taskBuffers[task].sumRight.data() : _wideBuffers[task].sumRight.data());
+        if (task == 0) {
+            std::copy(sum, sum + renderFrames, mix);
+            if (stereo) {
+                std::copy(sumRight, sumRight + renderFrames, mixRight);
+            }
+            continue;
+        }
+        for (size_t i = 0; i < renderFrames; i++) {
+            mix[i] += sum[i];
+        }
+        if (stereo) {
+            for (size_t i = 0; i < renderFrames; i++) {
+                mixRight[i] += sumRight[i];
+            }
+        }
+    }
+    if (numTasks == 0) {
+        std::fill(mix, mix + renderFrames, 0.0f);
+        std::fill(mixRight, mixRight + renderFrames, 0.0f);
+    }
+
+    if (factor != 1) {
+        _oversampler.Downsample(mix, left, frames);
+        if (stereo) {
+            _oversamplerRight.Downsample(mixRight, right, frames);
+        }
+    }
+
+    if (stereo) {
+        if (_gainLeft.IsSmoothing() || _gainRight.IsSmoothing()) {
+            _gainRight.ApplyGain(right, right, frames);
+            _gainLeft.ApplyGain(left, left, frames);
+        } else {
+            kernels::Gain(left, left, _gainLeft.Current(), frames);
+            kernels::Gain(right, right, _gainRight.Current(), frames);
+        }
+    } else if (_gainLeft.IsSmoothing() || _gainRight.IsSmoothing()) {
+        _gainRight.ApplyGain(left, right, frames);
+        _gainLeft.ApplyGain(left, left, frames);
+    } else {
+        kernels::Pan(left, left, right, _gainLeft.Current(), _gainRight.Current(), frames);
+    }
 }
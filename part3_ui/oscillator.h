@@ -1,10 +1,21 @@
 #pragma once
 
 #include "constants.h"
+#include "wavetable.h"
+#include "param.h"
+#include "event.h"
+#include "kernels.h"
+#include "oversampler.h"
+#include "filter.h"
+#include "envelope.h"
+#include "modmatrix.h"
 #include <atomic>
 #include <array>
+#include <vector>
+#include <stddef.h>
 
 struct Synth;
+struct Voice;
 
 namespace oscillator {
 
@@ -14,47 +25,246 @@ float Square(float phase);
 float Saw(float phase);
 float Triangle(float phase);
 float Whitenoise(float phase);
+float Silence(float phase); // stands in for sources with no waveform
 
 }
 
+// One oscillator of the bank, OSC A to C. Pitch is on top of the note and
+// the global pitch.
+struct BankOscillatorParams {
+    uint32_t sourceIndex = 0; // range [0, Oscillator::NumSources() - 1]
+    float mix = 0.f; // range [0, 1], silent at 0
+    float coarse = 0.f; // semitones, range [-24, 24]
+    float fine = 0.f; // cents, range [-100, 100]
+};
+
+// User-facing oscillator settings
+struct OscillatorParams {
+    float volume = 0.7f; // range [0, 1]
+    float pan = 0.0f; // range [-.5, .5]
+    float coarsePitch = 0.0f; // semitones, range [-36,36]
+    float finePitch = 0.0f; // cents, range [-100,100]
+    float drive = 0.0f; // saturation, range [0, 1]
+    // Voices and drive run at this multiple of the sample rate (1, 2, 4 or
+    // 8), then are filtered back down. Costs about factor times the CPU per
+    // voice, so only worth it where drive or noise would alias.
+    // One factor for the whole voice, not per bank oscillator: the bank is
+    // summed before the filter and drive, which are what alias, and all
+    // voices share one decimation filter.
+    uint32_t oversampling = 1;
+    uint32_t filterType = 0; // filter::Type, range [0, filter::NUM_TYPES - 1]
+    float cutoffHz = filter::MAX_CUTOFF_HZ; // range [filter::MIN_CUTOFF_HZ, filter::MAX_CUTOFF_HZ]
+    float resonance = 0.0f; // range [0, 1]
+    EnvelopeParams envelope; // amplitude
+    uint32_t unison = 1; // detuned copies per voice, range [1, MAX_UNISON]
+    float detune = 0.2f; // pitch spread of the copies, range [0, 1]
+    float spread = 0.5f; // stereo width of the copies, range [0, 1]
+    // OSC A alone by default. B is a saw, C a square an octave down.
+    std::array<BankOscillatorParams, NUM_OSCILLATORS> bank = {{
+        { 0, 1.f, 0.f, 0.f },
+        { 2, 0.f, 0.f, 0.f },
+        { 1, 0.f, -12.f, 0.f },
+    }};
+};
+
 class Oscillator {
 public:
     struct Source {
         const char* name;
         oscillator::Fn fn;
+        bool periodic; // played from a band-limited wavetable
+        bool sampled; // played by Synth::sampler, fn unused
     };
 
     bool Init(Synth* synth);
-    void Prev();
-    void Next();
-    const char* GetName() const { return _sources[_sourceIndex].name; }
-    float Fn(float phase) const { return _sources[_sourceIndex].fn(phase); }
-    void GetSample(float* left, float* right);
 
-    // Controllable from UI
+    // Available sources, safe to call from any thread
+    static uint32_t NumSources() { return (uint32_t)_sources.size(); }
+    static uint32_t PrevSource(uint32_t index);
+    static uint32_t NextSource(uint32_t index);
+    static const char* SourceName(uint32_t index) { return _sources[index].name; }
+    static float SourceFn(uint32_t index, float phase) { return _sources[index].fn(phase); }
+
+    // Audio thread: apply control changes sent from the UI. oscillator
+    // picks one of the bank, for SetSource() and the Osc* params.
+    void SetParam(Event::Param param, float value, uint32_t oscillator = 0);
+    void SetSource(uint32_t index, uint32_t oscillator = 0);
+
+    // Audio thread: all settings at once, for a patch change
+    void SetParams(const OscillatorParams& params);
+
+    // Render all active voices for a block of frames into separate
+    // (non-interleaved) buffers. frames must be <= BLOCK_FRAMES.
+    void Process(float* left, float* right, size_t frames);
+
+    // Controllable from any thread
     std::atomic<bool> enabled{true};
-    std::atomic<float> volume{0.7f}; // range [0, 1]
-    std::atomic<float> pan{0.0f}; // range [-.5, .5]
-    std::atomic<float> coarsePitch{0.0f}; // semitones, range [-36,36]
-    std::atomic<float> finePitch{0.0f}; // cents, range [-100,100]
-    std::atomic<bool> noteActive{false}; // whether note should play
-    std::atomic<uint8_t> noteIndex{39}; // C3, 0-based on 88-key piano, index 0 is note A1
+    std::atomic<Wavetable::Interpolation> interpolation{Wavetable::Interpolation::Cubic};
 
 private:
-    float GetFrequency() const;
+    static float GetFrequency(uint8_t note, float pitchCents);
+
+    // Pull _params into the smoothed audio-thread state. Derived values
+    // are only recomputed when their inputs change.
+    void UpdateControls(size_t frames);
+
+    static constexpr float GAIN_SMOOTHING_MS = 10.f;
+    static constexpr float PITCH_SMOOTHING_MS = 5.f;
+    static constexpr float CUTOFF_SMOOTHING_MS = 5.f;
+
+    // Knob ranges, for modulation amounts (see mod::Dest)
+    static constexpr float COARSE_RANGE_SEMITONES = 72.f;
+    static constexpr float FINE_RANGE_CENTS = 200.f;
+
+    // Bank oscillator pitch offsets
+    static constexpr float MAX_BANK_SEMITONES = 24.f;
+    static constexpr float MAX_BANK_CENTS = 100.f;
+
+    // Per-voice modulation at block rate, on top of the global values
+    float VoicePitchRatio(const mod::Offsets& offsets) const;
+    float VoiceGain(const mod::Offsets& offsets) const;
+
+    // Drive is a gain into a soft clipper, blended in with the dry signal
+    // as drive goes from 0 to 1. At 0 the clipper is skipped. Each voice
+    // is driven on its own, after its filter and before its envelope, so
+    // notes don't intermodulate and the amount doesn't depend on how many
+    // are playing.
+    static constexpr float MAX_DRIVE_GAIN = 16.f;
+    static float DriveGain(float drive) { return 1.f + (MAX_DRIVE_GAIN - 1.f) * drive; }
+
+    // Unison copies are spaced evenly in pitch, lowest to highest, and
+    // panned the same way, left to right, as far as spread allows. At full
+    // detune the outermost two are MAX_DETUNE_CENTS apart. Copies are
+    // mixed at equal power, so adding them doesn't make the voice louder.
+    static constexpr float MAX_DETUNE_CENTS = 100.f;
+    static constexpr float UNISON_JITTER = 0.6f; // of the spacing, see UpdateUnison()
+    void UpdateUnison();
+
+    static constexpr size_t MAX_RENDER_FRAMES = BLOCK_FRAMES * Oversampler::MAX_FACTOR;
+
+    // Voices are rendered in fixed groups, each summed into its own buffer
+    // and then added up in group order. Output doesn't depend on which
+    // thread rendered which group. Groups are spread over worker threads
+    // once there are enough voices to be worth waking them. A group is
+    // filtered together, one voice per SIMD lane. Voices have their
+    // envelope applied on the way into the sum.
+    static constexpr size_t VOICES_PER_TASK = kernels::FILTER_LANES;
+    static constexpr size_t MAX_TASKS = (MAX_VOICES + VOICES_PER_TASK - 1) / VOICES_PER_TASK;
+    static constexpr size_t PARALLEL_MIN_VOICES = 16;
+    static void RenderTask(void* context, size_t task);
+    template <typename Buffers>
+    void RenderVoices(Buffers& buffers, size_t task);
+
+    // With unison on, every voice is rendered in stereo, its copies
+    // kernels::UNISON_LANES at a time, and the group is summed into sum
+    // and sumRight
+    template <typename Buffers>
+    void RenderUnisonVoices(Buffers& buffers, size_t task);
 
     static constexpr float A0Freq = 27.5f;
-    static constexpr std::array<Source, 5> _sources = {{
-        { "Sine", oscillator::Sine },
-        { "Square", oscillator::Square },
-        { "Saw", oscillator::Saw },
-        { "Triangle", oscillator::Triangle },
-        { "Whitenoise", oscillator::Whitenoise },
+    static constexpr std::array<Source, 6> _sources = {{
+        { "Sine", oscillator::Sine, true, false },
+        { "Square", oscillator::Square, true, false },
+        { "Saw", oscillator::Saw, true, false },
+        { "Triangle", oscillator::Triangle, true, false },
+        { "Whitenoise", oscillator::Whitenoise, false, false },
+        { "Sampler", oscillator::Silence, false, true },
     }};
 
-    // Controllable from UI
-    std::atomic<uint32_t> _sourceIndex{0}; // range [0, _sources.size() - 1]
-
     Synth* _synth = nullptr;
-    float _phase = 0.0f; // radians
+
+    // Built in Init(), one per periodic source
+    std::array<Wavetable, _sources.size()> _wavetables;
+
+    // Audio thread state. _params is updated by events from the UI.
+    OscillatorParams _params;
+    std::array<float, NUM_KEYS> _noteFrequencies = {};
+    SmoothedParam _gainLeft;
+    SmoothedParam _gainRight;
+    SmoothedParam _pitchCents;
+    float _pitchRatio = 1.f; // from _pitchCents
+    SmoothedParam _cutoffOctaves; // above MIN_CUTOFF_HZ, smoothed at block rate
+    float _cutoffHz = filter::MAX_CUTOFF_HZ; // from _cutoffOctaves
+    float _volume = 0.f; // with global modulation
+    float _coarsePitch = 0.f; // semitones, with global modulation, not rounded yet
+    float _lastVolume = 0.f;
+    float _lastPan = 0.f;
+    float _lastCutoffHz = 0.f;
+    float _lastDrive = 0.f; // at the end of the previous block
+    Envelope::Rates _envelopeRates;
+    Oversampler _oversampler;
+    Oversampler _oversamplerRight; // only used with unison on
+    bool _wasStereo = false; // unison was on last block
+
+    // Per unison copy, from UpdateUnison()
+    std::array<float, MAX_UNISON> _unisonRatios = {}; // frequency multiple
+    std::array<float, MAX_UNISON> _unisonGainLeft = {};
+    std::array<float, MAX_UNISON> _unisonGainRight = {};
+    uint32_t _lastUnison = 0;
+    float _lastDetune = 0.f;
+    float _lastSpread = 0.f;
+
+    // Snapshot of the block being rendered, read by RenderTask()
+    struct Block {
+        // Sounding oscillators of the bank, in order
+        struct Slot {
+            const Source* source;
+            const Wavetable* wavetable;
+            uint32_t index; // into the bank, and Voice::phases
+            float ratio; // of the note's frequency
+            float gain;
+        };
+        std::array<Slot, NUM_OSCILLATORS> slots;
+        uint32_t numSlots;
+        Wavetable::Interpolation interp;
+        uint32_t factor; // oversampling
+        size_t frames; // at the oversampled rate
+        filter::Type filterType;
+        float renderRateHz; // oversampled rate
+        float cutoffHz;
+        float resonance;
+        bool voiceMods; // any per-voice modulation routes
+        float driveStart; // ramped over the block
+        float driveEnd;
+        uint32_t unison; // copies per voice, rendered in stereo when > 1
+    };
+    Block _block = {};
+
+    // One voice's bank at freqHz, summed oscillator by oscillator straight
+    // into out (or left and right with unison on), so there is one buffer
+    // per voice however many oscillators are on. scratch holds noise and
+    // samples on their way into the sum.
+    void RenderBank(const Block& block, Voice& voice, float freqHz, float* out, float* scratch) const;
+    void RenderBankUnison(const Block& block, Voice& voice, float freqHz, float* left, float* right, float* scratch) const;
+
+    // Saturate one voice in place, see DriveGain()
+    static void DriveVoice(const Block& block, float* voice);
+
+    // Scale a voice's gains over the block by its steal fade, and move the
+    // fade on. Linear over VoicePool::STEAL_FADE_FRAMES however the blocks
+    // are split.
+    static void FadeStolen(const Block& block, Voice& voice, float& gainStart, float& gainEnd);
+
+    // A source without a wavetable, written to out at the slot's pitch
+    void RenderSource(const Block& block, const Block::Slot& slot, Voice& voice, float freqHz, float* out) const;
+
+    // Per-task buffers: each voice's output, and the group's sum. The
+    // right channel is only used with unison on, otherwise voices are
+    // mono until the mix is panned.
+    template <size_t FRAMES>
+    struct alignas(64) TaskBuffers {
+        std::array<std::array<float, FRAMES>, VOICES_PER_TASK> voices;
+        std::array<std::array<float, FRAMES>, VOICES_PER_TASK> voicesRight;
+        std::array<float, FRAMES> sum;
+        std::array<float, FRAMES> sumRight;
+        std::array<float, FRAMES> scratch;
+    };
+    std::array<TaskBuffers<BLOCK_FRAMES>, MAX_TASKS> _taskBuffers = {};
+
+    // The same when oversampling, kept apart so the common case stays
+    // compact. Allocated in Init(), with the mix of all voices before
+    // decimation.
+    std::vector<TaskBuffers<MAX_RENDER_FRAMES>> _wideBuffers;
+    std::vector<float> _mix;
+    std::vector<float> _mixRight;
 };
@@ -0,0 +1,167 @@
+#include "oversampler.h"
+#include "kernels.h"
+#include "utility.h"
+#include <SDL.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+//-----------------------
+// Halfband
+//-----------------------
+
+// A halfband lowpass h[n] of length 4K - 1 is a windowed sinc with cutoff
+// at a quarter of the high rate. It's zero at every even distance from the
+// center c = 2K - 1, and 1/2 at the center. Writing the nonzero taps as
+// g[j] = h[2j]:
+//
+//   decimate:    y[m]      = sum(g[j] * x[2(m-j)]) + x[2(m-K)+1] / 2
+//   interpolate: y[2m]     = 2 * sum(g[j] * x[m-j])
+//                y[2m + 1] = x[m-K+1]
+//
+// so both directions are a 2K tap FIR at the low rate plus a delay.
+void Oversampler::Halfband::Init(size_t halfTaps, size_t maxLowFrames) {
+    _halfTaps = halfTaps;
+    size_t taps = 2 * halfTaps;
+    _history = taps - 1;
+
+    double center = (double)(2 * halfTaps - 1);
+    double sum = 0.0;
+    std::vector<double> coeffs(taps);
+    for (size_t j = 0; j < taps; j++) {
+        double t = (double)(2 * j) - center; // odd
+        double x = M_PI * t / 2.0;
+        coeffs[j] = 0.5 * (sin(x) / x) * utility::Kaiser(t / (center + 1.0), KAISER_BETA);
+        sum += coeffs[j];
+    }
+    // Unity gain at DC, with the center tap's 1/2
+    _coeffs.resize(taps);
+    _upCoeffs.resize(taps);
+    for (size_t j = 0; j < taps; j++) {
+        _coeffs[j] = (float)(coeffs[j] * 0.5 / sum);
+        _upCoeffs[j] = 2.f * _coeffs[j];
+    }
+
+    _even.assign(_history + maxLowFrames, 0.f);
+    _odd.assign(_history + maxLowFrames, 0.f);
+    _up.assign(_history + maxLowFrames, 0.f);
+    _scratch.assign(maxLowFrames, 0.f);
+}
+
+void Oversampler::Halfband::Reset() {
+    std::fill(_even.begin(), _even.end(), 0.f);
+    std::fill(_odd.begin(), _odd.end(), 0.f);
+    std::fill(_up.begin(), _up.end(), 0.f);
+}
+
+void Oversampler::Halfband::Decimate(const float* in, float* out, size_t frames) {
+    float* even = _even.data() + _history;
+    float* odd = _odd.data() + _history;
+    for (size_t m = 0; m < frames; m++) {
+        even[m] = in[2 * m];
+        odd[m] = in[2 * m + 1];
+    }
+
+    kernels::Fir(_coeffs.data(), _coeffs.size(), _even.data(), out, frames);
+    const float* delayed = _odd.data() + _halfTaps - 1;
+    for (size_t m = 0; m < frames; m++) {
+        out[m] += 0.5f * delayed[m];
+    }
+
+    memmove(_even.data(), _even.data() + frames, _history * sizeof(float));
+    memmove(_odd.data(), _odd.data() + frames, _history * sizeof(float));
+}
+
+void Oversampler::Halfband::Interpolate(const float* in, float* out, size_t frames) {
+    memcpy(_up.data() + _history, in, frames * sizeof(float));
+    kernels::Fir(_upCoeffs.data(), _upCoeffs.size(), _up.data(), _scratch.data(), frames);
+    kernels::Interleave(_scratch.data(), _up.data() + _halfTaps, out, frames);
+    memmove(_up.data(), _up.data() + frames, _history * sizeof(float));
+}
+
+//-----------------------
+// Oversampler
+//-----------------------
+
+bool Oversampler::Init(size_t maxFrames) {
+    if (maxFrames == 0) {
+        SDL_Log("Oversampler needs a block size");
+        return false;
+    }
+    _maxFrames = maxFrames;
+    for (size_t s = 0; s < NUM_STAGES; s++) {
+        _stages[s].Init(HALF_TAPS[s], maxFrames << s);
+    }
+    _bufferA.assign(MAX_FACTOR / 2 * maxFrames, 0.f);
+    _bufferB.assign(MAX_FACTOR / 2 * maxFrames, 0.f);
+    return true;
+}
+
+bool Oversampler::IsValidFactor(uint32_t factor) {
+    return (factor == 1 || factor == 2 || factor == 4 || factor == 8);
+}
+
+bool Oversampler::SetFactor(uint32_t factor) {
+    if (!IsValidFactor(factor)) {
+        return false;
+    }
+    if (factor != _factor) {
+        _factor = factor;
+        Reset();
+    }
+    return true;
+}
+
+size_t Oversampler::NumStages() const {
+    size_t stages = 0;
+    for (uint32_t f = _factor; f > 1; f /= 2) {
+        stages++;
+    }
+    return stages;
+}
+
+float Oversampler::LatencyFrames() const {
+    float latency = 0.f;
+    for (size_t s = 0; s < NumStages(); s++) {
+        latency += 2.f * _stages[s].LatencyLowFrames() / (float)(1u << s);
+    }
+    return latency;
+}
+
+void Oversampler::Reset() {
+    for (Halfband& stage : _stages) {
+        stage.Reset();
+    }
+}
+
+void Oversampler::Upsample(const float* in, float* out, size_t frames) {
+    size_t stages = NumStages();
+    if (stages == 0) {
+        std::copy(in, in + frames, out);
+        return;
+    }
+
+    // Lowest rate first, the last stage writes to out
+    const float* src = in;
+    for (size_t s = 0; s < stages; s++) {
+        float* dst = (s + 1 == stages ? out : (s % 2 == 0 ? _bufferA.data() : _bufferB.data()));
+        _stages[s].Interpolate(src, dst, frames << s);
+        src = dst;
+    }
+}
+
+void Oversampler::Downsample(const float* in, float* out, size_t frames) {
+    size_t stages = NumStages();
+    if (stages == 0) {
+        std::copy(in, in + frames, out);
+        return;
+    }
+
+    // Highest rate first, the last stage writes to out
+    const float* src = in;
+    for (size_t s = stages; s-- > 0;) {
+        float* dst = (s == 0 ? out : ((stages - s) % 2 == 1 ? _bufferA.data() : _bufferB.data()));
+        _stages[s].Decimate(src, dst, frames << s);
+        src = dst;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+// Runs a stage at 2x, 4x or 8x the sample rate, for sources and effects
+// that would alias at the base rate. Each doubling is a linear phase FIR
+// halfband filter in polyphase form: every other tap of a halfband is
+// zero, so only the nonzero ones are computed, at the lower of its two
+// rates. Buffers are allocated in Init(), nothing else allocates.
+//
+// Upsample() and Downsample() keep separate state, so a non-linear stage
+// can be wrapped as
+//   Upsample(in, wide, n); Shape(wide, n * Factor()); Downsample(wide, out, n);
+// and a source that renders at the higher rate only needs Downsample().
+class Oversampler {
+public:
+    static constexpr uint32_t MAX_FACTOR = 8;
+
+    // maxFrames is the most base rate frames per call
+    bool Init(size_t maxFrames);
+
+    // 1, 2, 4 or 8. Clears the filter state if the factor changes.
+    bool SetFactor(uint32_t factor);
+    uint32_t Factor() const { return _factor; }
+    static bool IsValidFactor(uint32_t factor);
+
+    // Delay added by Upsample() + Downsample(), in base rate frames
+    float LatencyFrames() const;
+
+    void Reset();
+
+    // frames base rate samples in, frames * Factor() samples out
+    void Upsample(const float* in, float* out, size_t frames);
+
+    // frames * Factor() samples in, frames base rate samples out
+    void Downsample(const float* in, float* out, size_t frames);
+
+private:
+    // One doubling, between rate R (low) and 2R (high)
+    class Halfband {
+    public:
+        // halfTaps nonzero taps on each side of the center one, so the
+        // filter is 4 * halfTaps - 1 long and its polyphase branch
+        // 2 * halfTaps
+        void Init(size_t halfTaps, size_t maxLowFrames);
+        void Reset();
+        float LatencyLowFrames() const { return (float)(2 * _halfTaps - 1) / 2.f; }
+
+        // 2 * frames in, frames out
+        void Decimate(const float* in, float* out, size_t frames);
+
+        // frames in, 2 * frames out
+        void Interpolate(const float* in, float* out, size_t frames);
+
+    private:
+        size_t _halfTaps = 0;
+        size_t _history = 0; // taps - 1 of the polyphase branch
+        std::vector<float> _coeffs; // branch of nonzero taps, sums to 1/2
+        std::vector<float> _upCoeffs; // _coeffs * 2, for the zero stuffed input
+
+        // Inputs with _history previous samples in front. The decimator
+        // splits its input into even and odd samples.
+        std::vector<float> _even;
+        std::vector<float> _odd;
+        std::vector<float> _up;
+        std::vector<float> _scratch;
+    };
+
+    // Stage s runs between base * 2^s and base * 2^(s+1). The first one
+    // guards the audible band and needs the steepest filter, later ones
+    // only have to keep images away from it and can be much shorter.
+    static constexpr size_t NUM_STAGES = 3;
+    static constexpr std::array<size_t, NUM_STAGES> HALF_TAPS = {{ 16, 5, 4 }};
+    static constexpr double KAISER_BETA = 8.0; // about -80 dB stopband
+
+    std::array<Halfband, NUM_STAGES> _stages;
+    size_t NumStages() const;
+
+    // Ping-pong buffers between stages, MAX_FACTOR / 2 * maxFrames each
+    std::vector<float> _bufferA;
+    std::vector<float> _bufferB;
+    size_t _maxFrames = 0;
+    uint32_t _factor = 1;
+};
@@ -0,0 +1,77 @@
+#include "param.h"
+#include "constants.h"
+#include "kernels.h"
+#include <math.h>
+#include <algorithm>
+
+void SmoothedParam::Init(Mode mode, float timeMs, float value, float sampleRateHz) {
+    _mode = mode;
+    _current = value;
+    _target = value;
+    _remaining = 0;
+    _step = 0.f;
+
+    float timeFrames = std::max(timeMs / 1000.f * sampleRateHz, 1.f);
+    _rampFrames = (uint32_t)timeFrames;
+    _coeff = expf(-1.f / timeFrames);
+}
+
+void SmoothedParam::SetTarget(float target) {
+    if (target == _target) {
+        return;
+    }
+    _target = target;
+    if (_mode == Mode::Linear) {
+        _remaining = _rampFrames;
+        _step = (_target - _current) / (float)_rampFrames;
+    }
+}
+
+float SmoothedParam::Skip(size_t frames) {
+    if (!IsSmoothing()) {
+        return _current;
+    }
+
+    if (_mode == Mode::Linear) {
+        if (frames >= _remaining) {
+            _current = _target;
+            _remaining = 0;
+        } else {
+            _current += _step * (float)frames;
+            _remaining -= (uint32_t)frames;
+        }
+    } else {
+        _current = _target + (_current - _target) * powf(_coeff, (float)frames);
+        if (fabsf(_target - _current) < EPSILON) {
+            _current = _target;
+        }
+    }
+    return _current;
+}
+
+void SmoothedParam::ApplyGain(const float* in, float* out, size_t frames) {
+    size_t i = 0;
+    if (IsSmoothing()) {
+        if (_mode == Mode::Linear) {
+            size_t rampFrames = std::min(frames, (size_t)_remaining);
+            float value = _current;
+            for (; i < rampFrames; i++) {
+                value += _step;
+                out[i] = in[i] * value;
+            }
+            _remaining -= (uint32_t)rampFrames;
+            _current = (_remaining == 0 ? _target : value);
+        } else {
+            float value = _current;
+            float a = 1.f - _coeff;
+            for (; i < frames; i++) {
+                value += (_target - value) * a;
+                out[i] = in[i] * value;
+            }
+            _current = (fabsf(_target - value) < EPSILON ? _target : value);
+        }
+    }
+
+    // Settled, constant gain for the rest of the block
+    kernels::Gain(in + i, out + i, _current, frames - i);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Audio-thread smoothing of a control value. The target is set once per
+// block from a UI snapshot, and the value ramps toward it at audio rate
+// so knob jumps don't produce zipper noise.
+class SmoothedParam {
+public:
+    enum class Mode {
+        Linear, // reach target in a fixed time
+        OnePole, // exponential approach, timeMs is the time constant
+    };
+
+    void Init(Mode mode, float timeMs, float value, float sampleRateHz);
+    void SetTarget(float target);
+
+    float Current() const { return _current; }
+    float Target() const { return _target; }
+    bool IsSmoothing() const { return _current != _target; }
+
+    // Advance by frames, for values only needed once per block
+    float Skip(size_t frames);
+
+    // out[i] = in[i] * value, with value advancing every sample. in and
+    // out may be the same buffer.
+    void ApplyGain(const float* in, float* out, size_t frames);
+
+private:
+    // Close enough to stop a one-pole ramp
+    static constexpr float EPSILON = 1e-5f;
+
+    Mode _mode = Mode::Linear;
+    float _current = 0.f;
+    float _target = 0.f;
+
+    // Linear
+    uint32_t _rampFrames = 0;
+    uint32_t _remaining = 0; // frames left in the current ramp
+    float _step = 0.f;
+
+    // One-pole
+    float _coeff = 0.f; // per-sample feedback coefficient
+};
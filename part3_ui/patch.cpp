@@ -0,0 +1,122 @@
+#include "patch.h"
+#include "synth.h"
+#include <array>
+
+//-----------------------
+// Factory patches
+//-----------------------
+
+static std::array<Patch, 5> MakeFactoryPatches() {
+    std::array<Patch, 5> patches;
+
+    Patch& supersaw = patches[1];
+    supersaw.name = "Supersaw";
+    supersaw.osc.bank[0].sourceIndex = 2; // saw
+    supersaw.osc.unison = 7;
+    supersaw.osc.detune = 0.35f;
+    supersaw.osc.spread = 0.8f;
+    supersaw.osc.filterType = (uint32_t)filter::Type::LowPass;
+    supersaw.osc.cutoffHz = 6000.f;
+    supersaw.osc.envelope.releaseMs = 400.f;
+    supersaw.delay.enabled = true;
+    supersaw.delay.sync = DelaySync::DottedEighth;
+    supersaw.delay.feedback = 0.35f;
+    supersaw.delay.mix = 0.2f;
+    supersaw.reverb.enabled = true;
+    supersaw.reverb.decaySec = 2.5f;
+
+    Patch& pluck = patches[2];
+    pluck.name = "Pluck";
+    pluck.osc.bank[0].sourceIndex = 2; // saw
+    pluck.osc.bank[2].mix = 0.5f; // square an octave down
+    pluck.osc.filterType = (uint32_t)filter::Type::Ladder;
+    pluck.osc.cutoffHz = 1800.f;
+    pluck.osc.resonance = 0.3f;
+    pluck.osc.envelope = { 1.f, 250.f, 0.f, 200.f };
+    pluck.delay.enabled = true;
+    pluck.delay.sync = DelaySync::Eighth;
+    pluck.delay.mix = 0.3f;
+
+    Patch& pad = patches[3];
+    pad.name = "Pad";
+    pad.osc.bank[0].sourceIndex = 3; // triangle
+    pad.osc.bank[1].mix = 0.6f; // saw
+    pad.osc.bank[1].fine = 7.f;
+    pad.osc.filterType = (uint32_t)filter::Type::LowPass;
+    pad.osc.cutoffHz = 3000.f;
+    pad.osc.envelope = { 800.f, 1000.f, 0.8f, 1500.f };
+    pad.mod.lfos[0] = { mod::LfoShape::Sine, 0.3f };
+    pad.mod.lfos[1] = { mod::LfoShape::Triangle, 0.15f };
+    pad.mod.routes[0] = { mod::Source::Lfo1, mod::Dest::FinePitch, 0.05f };
+    pad.mod.routes[1] = { mod::Source::Lfo2, mod::Dest::Pan, 0.4f };
+    pad.reverb.enabled = true;
+    pad.reverb.decaySec = 5.f;
+    pad.reverb.damping = 0.4f;
+    pad.reverb.mix = 0.4f;
+
+    Patch& bass = patches[4];
+    bass.name = "Sub Bass";
+    bass.osc.bank[2].mix = 0.3f; // square an octave down
+    bass.osc.drive = 0.3f;
+    bass.osc.oversampling = 2; // keeps the driven square from aliasing
+    bass.osc.filterType = (uint32_t)filter::Type::LowPass;
+    bass.osc.cutoffHz = 400.f;
+    bass.osc.resonance = 0.2f;
+    bass.osc.envelope = { 2.f, 300.f, 1.f, 120.f };
+
+    return patches;
+}
+
+static const std::array<Patch, 5>& FactoryPatches() {
+    static const std::array<Patch, 5> patches = MakeFactoryPatches();
+    return patches;
+}
+
+uint32_t NumFactoryPatches() {
+    return (uint32_t)FactoryPatches().size();
+}
+
+const Patch& FactoryPatch(uint32_t index) {
+    return FactoryPatches()[index < NumFactoryPatches() ? index : 0];
+}
+
+//-----------------------
+// PatchSwap
+//-----------------------
+
+PatchSwap::~PatchSwap() {
+    delete _pending.load();
+    Compiled* patch = nullptr;
+    while (_retired.TryPop(&patch)) {
+        delete patch;
+    }
+}
+
+void PatchSwap::Publish(const Patch& patch, mod::Matrix* matrix) {
+    Compiled* compiled = nullptr;
+    while (_retired.TryPop(&compiled)) {
+        delete compiled;
+    }
+
+    compiled = new Compiled();
+    compiled->patch = patch;
+    matrix->Compile(patch.mod, &compiled->modTable);
+
+    // As in mod::Matrix::Publish(), one still pending was never seen
+    delete _pending.exchange(compiled, std::memory_order_acq_rel);
+}
+
+void PatchSwap::Apply(Synth* synth) {
+    // Only when the patch can be handed back, see mod::Matrix::Process()
+    if (_retired.Full()) {
+        return;
+    }
+    Compiled* compiled = _pending.exchange(nullptr, std::memory_order_acq_rel);
+    if (compiled == nullptr) {
+        return;
+    }
+    synth->osc.SetParams(compiled->patch.osc);
+    synth->mod.Load(compiled->modTable);
+    synth->effects.SetParams(compiled->patch.delay, compiled->patch.reverb);
+    _retired.TryPush(compiled);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "oscillator.h"
+#include "modmatrix.h"
+#include "delay.h"
+#include "reverb.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <stdint.h>
+
+struct Synth;
+
+// A whole sound: the oscillator bank, filter, envelope, modulation and
+// effects, everything the UI's knobs set.
+struct Patch {
+    const char* name = "Init";
+    OscillatorParams osc;
+    mod::Settings mod;
+    DelayParams delay;
+    ReverbParams reverb;
+};
+
+// Built-in patches, the first is the defaults
+uint32_t NumFactoryPatches();
+const Patch& FactoryPatch(uint32_t index);
+
+// Switches the engine to a whole patch at once, at an exact frame. The UI
+// thread publishes the patch, compiled into everything the audio thread
+// needs, then sends Event::PatchChange. At that event the audio thread
+// takes the newest published patch with one atomic exchange and copies it
+// into the engine, all between two frames: no allocating, locking or
+// table building. Knobs that are smoothed glide to their new values as if
+// they had all been turned at once. The patch is then handed back to be
+// freed by the UI thread on its next Publish(), like the mod matrix's
+// tables.
+class PatchSwap {
+public:
+    ~PatchSwap();
+
+    // UI thread. Replaces a patch published but not yet changed to.
+    void Publish(const Patch& patch, mod::Matrix* matrix);
+
+    // Audio thread, for Event::PatchChange. Does nothing if there is no
+    // new patch.
+    void Apply(Synth* synth);
+
+private:
+    struct Compiled {
+        Patch patch;
+        mod::Matrix::Table modTable;
+    };
+
+    // UI -> audio: the newest patch not yet changed to
+    std::atomic<Compiled*> _pending{nullptr};
+
+    // Audio -> UI: patches applied, freed on the next Publish()
+    SpscQueue<Compiled*, 16> _retired;
+};
@@ -0,0 +1,273 @@
+#include "render.h"
+#include "audio.h"
+#include "synth.h"
+#include "wav.h"
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace render {
+
+static constexpr uint32_t DEFAULT_TAIL_MS = 1000;
+
+// Offline clock, in ms of rendered audio
+static double _renderClockMs = 0.0;
+
+static double RenderClock() {
+    return _renderClockMs;
+}
+
+// Modulation isn't an event: settings are edited here and published to
+// the audio thread the way the UI does it, at the start of the block the
+// edit falls in
+struct ModEdit {
+    uint32_t timestampMs;
+    bool isLfo; // otherwise a route
+    uint32_t index;
+    float values[3]; // shape, rate or source, dest, amount
+};
+
+static void ApplyModEdit(const ModEdit& edit, mod::Settings* settings) {
+    if (edit.isLfo) {
+        mod::Lfo& lfo = settings->lfos[edit.index];
+        lfo.shape = (mod::LfoShape)std::min((uint32_t)edit.values[0], mod::NUM_LFO_SHAPES - 1);
+        lfo.rateHz = edit.values[1];
+    } else {
+        mod::Route& route = settings->routes[edit.index];
+        route.source = (mod::Source)std::min((uint32_t)edit.values[0], mod::NUM_SOURCES - 1);
+        route.dest = (mod::Dest)std::min((uint32_t)edit.values[1], mod::NUM_DESTS - 1);
+        route.amount = edit.values[2];
+    }
+}
+
+static bool ParseScript(const char* path, uint32_t songMs, std::vector<Event>* events, std::vector<ModEdit>* modEdits, uint32_t* endMs) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        SDL_Log("Could not open script %s", path);
+        return false;
+    }
+
+    bool haveEnd = false;
+    uint32_t lastMs = 0;
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+
+        uint32_t ms = 0;
+        char command[16] = {};
+        float values[4] = {};
+        int fields = sscanf(line, "%u %15s %f %f %f %f", &ms, command, &values[0], &values[1], &values[2], &values[3]);
+        if (fields <= 0) {
+            continue; // blank line
+        }
+        float value = values[0];
+        int numValues = fields - 2;
+
+        bool ok = true;
+        if (numValues == 0 && strcmp(command, "end") == 0) {
+            haveEnd = true;
+            *endMs = ms;
+        } else if (strcmp(command, "on") == 0 && (numValues == 1 || numValues == 2)) {
+            float velocity = (numValues == 2 ? values[1] : 1.f);
+            events->push_back(Event::NoteOn(ms, (uint8_t)value, velocity));
+        } else if (strcmp(command, "lfo") == 0 && numValues == 3 && value >= 1 && value <= mod::NUM_LFOS) {
+            modEdits->push_back({ ms, true, (uint32_t)value - 1, { values[1], values[2], 0.f } });
+        } else if (strcmp(command, "route") == 0 && numValues == 4 && value >= 1 && value <= mod::Settings::MAX_ROUTES) {
+            modEdits->push_back({ ms, false, (uint32_t)value - 1, { values[1], values[2], values[3] } });
+        } else if (strncmp(command, "osc", 3) == 0 && command[3] != '\0' && numValues == 2 && value >= 1 && value <= NUM_OSCILLATORS) {
+            // oscwave, oscmix, osccoarse, oscfine <n> <value>
+            uint8_t oscillator = (uint8_t)(value - 1);
+            const char* what = command + 3;
+            if (strcmp(what, "wave") == 0) {
+                events->push_back(Event::OscillatorSelect(ms, (uint32_t)values[1], oscillator));
+            } else if (strcmp(what, "mix") == 0) {
+                events->push_back(Event::ParamChange(ms, Event::Param::OscMix, values[1], oscillator));
+            } else if (strcmp(what, "coarse") == 0) {
+                events->push_back(Event::ParamChange(ms, Event::Param::OscCoarse, values[1], oscillator));
+            } else if (strcmp(what, "fine") == 0) {
+                events->push_back(Event::ParamChange(ms, Event::Param::OscFine, values[1], oscillator));
+            } else {
+                ok = false;
+            }
+        } else if (numValues != 1) {
+            ok = false;
+        } else if (strcmp(command, "off") == 0) {
+            events->push_back(Event::NoteOff(ms, (uint8_t)value));
+        } else if (strcmp(command, "volume") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Volume, value));
+        } else if (strcmp(command, "pan") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Pan, value));
+        } else if (strcmp(command, "coarse") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::CoarsePitch, value));
+        } else if (strcmp(command, "fine") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::FinePitch, value));
+        } else if (strcmp(command, "drive") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Drive, value));
+        } else if (strcmp(command, "oversample") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Oversampling, value));
+        } else if (strcmp(command, "filter") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::FilterType, value));
+        } else if (strcmp(command, "cutoff") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::FilterCutoff, value));
+        } else if (strcmp(command, "resonance") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::FilterResonance, value));
+        } else if (strcmp(command, "attack") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Attack, value));
+        } else if (strcmp(command, "decay") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Decay, value));
+        } else if (strcmp(command, "sustain") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Sustain, value));
+        } else if (strcmp(command, "release") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Release, value));
+        } else if (strcmp(command, "unison") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Unison, value));
+        } else if (strcmp(command, "detune") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Detune, value));
+        } else if (strcmp(command, "spread") == 0) {
+            events->push_back(Event::ParamChange(ms, Event::Param::Spread, value));
+        } else if (strcmp(command, "delay") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::DelayEnabled, value));
+        } else if (strcmp(command, "delaysync") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::DelaySync, value));
+        } else if (strcmp(command, "delaytime") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::DelayTime, value));
+        } else if (strcmp(command, "feedback") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::DelayFeedback, value));
+        } else if (strcmp(command, "delaymix") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::DelayMix, value));
+        } else if (strcmp(command, "tempo") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::Tempo, value));
+        } else if (strcmp(command, "reverb") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::ReverbEnabled, value));
+        } else if (strcmp(command, "reverbdecay") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::ReverbDecay, value));
+        } else if (strcmp(command, "damping") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::ReverbDamping, value));
+        } else if (strcmp(command, "reverbmix") == 0) {
+            events->push_back(Event::EffectChange(ms, Event::Effect::ReverbMix, value));
+        } else if (strcmp(command, "osc") == 0) {
+            events->push_back(Event::OscillatorSelect(ms, (uint32_t)value));
+        } else if (strcmp(command, "patch") == 0 && value >= 0 && value < (float)NumFactoryPatches()) {
+            events->push_back(Event::PatchChange(ms, (uint32_t)value));
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            SDL_Log("%s:%d: could not parse: %s", path, lineNumber, line);
+            fclose(file);
+            return false;
+        }
+        lastMs = std::max(lastMs, ms);
+    }
+    fclose(file);
+
+    std::stable_sort(events->begin(), events->end(), [](const Event& a, const Event& b) {
+        return a.timestampMs < b.timestampMs;
+    });
+    std::stable_sort(modEdits->begin(), modEdits->end(), [](const ModEdit& a, const ModEdit& b) {
+        return a.timestampMs < b.timestampMs;
+    });
+    if (!haveEnd) {
+        *endMs = std::max(lastMs, songMs) + DEFAULT_TAIL_MS;
+    }
+    return true;
+}
+
+bool RenderToFile(Synth* synth, const char* scriptPath, const char* wavPath) {
+    std::vector<Event> events;
+    std::vector<ModEdit> modEdits;
+    uint32_t endMs = 0;
+    // A song plays from the start of the render
+    uint32_t songMs = (uint32_t)ceil(synth->player.LengthMs());
+    if (!ParseScript(scriptPath, songMs, &events, &modEdits, &endMs)) {
+        return false;
+    }
+
+    WavWriter wav;
+    if (!wav.Open(wavPath, (uint32_t)synth->sampleRateHz, 2)) {
+        return false;
+    }
+
+    audio::SetClock(RenderClock);
+
+    size_t totalFrames = (size_t)((double)endMs * synth->sampleRateHz / 1000.0);
+    std::vector<float> buffer(2 * SAMPLES_PER_BUFFER);
+    size_t nextEvent = 0;
+    size_t nextModEdit = 0;
+    mod::Settings modSettings; // edits apply on top of the last patch
+    uint64_t engineTicks = 0;
+    uint64_t startTicks = SDL_GetPerformanceCounter();
+
+    for (size_t frame = 0; frame < totalFrames; frame += SAMPLES_PER_BUFFER) {
+        size_t frames = std::min((size_t)SAMPLES_PER_BUFFER, totalFrames - frame);
+        double blockEndMs = (double)(frame + frames) * 1000.0 / synth->sampleRateHz;
+
+        // Queue events that fall within this block. Patch changes are
+        // published the way the UI does it, just before their event. Only
+        // the newest published patch can be changed to, so a second one
+        // waits for the next block.
+        bool patchQueued = false;
+        while (nextEvent < events.size() && events[nextEvent].timestampMs < blockEndMs) {
+            const Event& event = events[nextEvent];
+            bool isPatch = (event.type == Event::Type::PatchChange);
+            if (isPatch && patchQueued) {
+                break;
+            }
+            if (isPatch) {
+                const Patch& patch = FactoryPatch(event.index);
+                synth->patches.Publish(patch, &synth->mod);
+                modSettings = patch.mod;
+                patchQueued = true;
+            }
+            if (!synth->events.TryPush(event)) {
+                break; // full, try again next block
+            }
+            nextEvent++;
+        }
+
+        bool modChanged = false;
+        while (nextModEdit < modEdits.size() && modEdits[nextModEdit].timestampMs < blockEndMs) {
+            ApplyModEdit(modEdits[nextModEdit++], &modSettings);
+            modChanged = true;
+        }
+        if (modChanged) {
+            synth->mod.Publish(modSettings);
+        }
+
+        _renderClockMs = blockEndMs;
+        uint64_t callbackStart = SDL_GetPerformanceCounter();
+        audio::AudioCallback(synth, (uint8_t*)buffer.data(), (int)(2 * frames * sizeof(float)));
+        engineTicks += SDL_GetPerformanceCounter() - callbackStart;
+
+        if (!wav.Write(buffer.data(), frames)) {
+            SDL_Log("Failed writing %s", wavPath);
+            return false;
+        }
+    }
+    if (!wav.Close()) {
+        SDL_Log("Failed writing %s", wavPath);
+        return false;
+    }
+
+    double freq = (double)SDL_GetPerformanceFrequency();
+    double audioSec = (double)totalFrames / synth->sampleRateHz;
+    double totalSec = (double)(SDL_GetPerformanceCounter() - startTicks) / freq;
+    double engineSec = (double)engineTicks / freq;
+    SDL_Log("-------------------");
+    SDL_Log("rendered:     %.2f s of audio to %s", audioSec, wavPath);
+    SDL_Log("wall time:    %.3f s (%.1fx real time)", totalSec, audioSec / totalSec);
+    SDL_Log("engine time:  %.3f s (%.1fx real time, %.1f ns/frame)",
+            engineSec, audioSec / engineSec, engineSec * 1e9 / (double)totalFrames);
+    SDL_Log("-------------------");
+    return true;
+}
+
+} // namespace render
@@ -0,0 +1,50 @@
+#pragma once
+
+struct Synth;
+
+namespace render {
+
+// Render an event script to a .wav file, as fast as the CPU allows, and
+// log the real-time factor. Doesn't need a window or audio device.
+//
+// Script format, one event per line, '#' starts a comment:
+//   <ms> on <note> [vel]  note on, note is 0-based on 88-key piano, velocity 0 to 1
+//   <ms> off <note>       note off
+//   <ms> volume <value>   also pan, coarse, fine, drive (same ranges as the UI)
+//   <ms> osc <index>      select oscillator source, of OSC A. 0 sine, 1 square,
+//                         2 saw, 3 triangle, 4 noise, 5 sampler (--samples)
+//   <ms> oscwave <n> <index>
+//                         source of bank oscillator n (1-3, OSC A to C), also
+//                         oscmix 0 to 1, osccoarse -24 to 24 st, oscfine -100
+//                         to 100 cents. OSC A starts at mix 1, B and C at 0.
+//   <ms> oversample <n>   voices and drive at 1, 2, 4 or 8 times the rate
+//   <ms> filter <type>    0 off, 1 lowpass, 2 bandpass, 3 highpass, 4 ladder
+//   <ms> cutoff <hz>      filter cutoff, 20 to 20000
+//   <ms> resonance <r>    filter resonance, 0 to 1
+//   <ms> attack <ms>      envelope times, 1 to 10000 ms, also decay, release
+//   <ms> sustain <level>  envelope sustain level, 0 to 1
+//   <ms> unison <n>       detuned copies per voice, 1 to 16, stereo above 1
+//   <ms> detune <d>       unison pitch spread, 0 to 1 (100 cents), also spread
+//                         for the stereo width, 0 to 1
+//   <ms> lfo <n> <shape> <hz>
+//                         LFO n (1-2): 0 sine, 1 triangle, 2 saw, 3 square
+//   <ms> route <n> <source> <dest> <amount>
+//                         modulation slot n (1-8). Sources 0 LFO 1, 1 LFO 2,
+//                         2 envelope, 3 velocity, 4 key. Dests 0 volume, 1 pan,
+//                         2 coarse, 3 fine. Amount -1 to 1 of the knob's range.
+//   <ms> delay <0|1>      stereo delay off or on
+//   <ms> delaysync <n>    0 free, 1 1/1, 2 1/2, 3 1/4, 4 1/8, 5 1/16, 6 1/4 dotted,
+//                         7 1/8 dotted, 8 1/4 triplet, 9 1/8 triplet
+//   <ms> delaytime <ms>   free delay time, 10 to 2000 ms
+//   <ms> tempo <bpm>      for synced delays, 40 to 240
+//   <ms> feedback <f>     delay feedback, 0 to 0.95, also delaymix 0 to 1
+//   <ms> reverb <0|1>     reverb off or on
+//   <ms> reverbdecay <s>  reverb decay time to -60 dB, 0.2 to 20 s
+//   <ms> damping <d>      reverb high frequency damping, 0 to 1, also reverbmix
+//   <ms> patch <index>    switch every setting to factory patch 0 (init),
+//                         1 supersaw, 2 pluck, 3 pad, 4 sub bass
+//   <ms> end              stop rendering (default: 1 s after last event, or
+//                         after the end of the --midi song if that's later)
+bool RenderToFile(Synth* synth, const char* scriptPath, const char* wavPath);
+
+} // namespace render
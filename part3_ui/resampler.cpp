@@ -0,0 +1,104 @@
+#include "resampler.h"
+#include "kernels.h"
+#include "utility.h"
+#include <SDL.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+bool Resampler::Init(float inRateHz, float outRateHz) {
+    double ratio = (double)outRateHz / (double)inRateHz;
+    if (ratio < 0.25 || ratio > 4.0) {
+        SDL_Log("Can't resample %.0f Hz to %.0f Hz", (double)inRateHz, (double)outRateHz);
+        return false;
+    }
+    _step = 1.0 / ratio;
+    _outRateHz = outRateHz;
+
+    // Cutoff as a fraction of the input rate, below the lower of the two
+    // Nyquist frequencies
+    double cutoff = 0.5 * PASSBAND * std::min(1.0, ratio);
+    double half = (double)TAPS / 2.0;
+    std::vector<float> table((PHASES + 1) * TAPS);
+    for (size_t p = 0; p <= PHASES; p++) {
+        double frac = (double)p / (double)PHASES;
+        double sum = 0.0;
+        for (size_t j = 0; j < TAPS; j++) {
+            // Distance from the output position to input tap j
+            double t = (double)j - (half - 1.0) - frac;
+            double x = 2.0 * cutoff * t;
+            double sinc = (x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x));
+            double h = 2.0 * cutoff * sinc * utility::Kaiser(t / half, KAISER_BETA);
+            table[p * TAPS + j] = (float)h;
+            sum += h;
+        }
+        // Unity gain at DC for every phase
+        for (size_t j = 0; j < TAPS; j++) {
+            table[p * TAPS + j] = (float)(table[p * TAPS + j] / sum);
+        }
+    }
+    _table.assign(table.begin(), table.begin() + PHASES * TAPS);
+    _deltas.resize(PHASES * TAPS);
+    for (size_t i = 0; i < PHASES * TAPS; i++) {
+        _deltas[i] = table[i + TAPS] - table[i];
+    }
+
+    // Room for the filter span plus the input of one Process() call
+    size_t capacity = TAPS + (size_t)ceil(MAX_OUTPUT_FRAMES * _step) + 2;
+    _left.assign(capacity, 0.f);
+    _right.assign(capacity, 0.f);
+
+    // Silence before the first input, so the first output is centered on
+    // it
+    _frames = TAPS / 2 - 1;
+    _pos = half - 1.0;
+
+    SDL_Log("Resampling %.0f Hz -> %.0f Hz", (double)inRateHz, (double)outRateHz);
+    return true;
+}
+
+size_t Resampler::InputNeeded(size_t outFrames) const {
+    if (outFrames == 0) {
+        return 0;
+    }
+    // Last tap of the last output
+    size_t last = (size_t)(_pos + (double)(outFrames - 1) * _step) + TAPS / 2;
+    return (last + 1 > _frames ? last + 1 - _frames : 0);
+}
+
+void Resampler::Push(const float* in, size_t frames) {
+    frames = std::min(frames, _left.size() - _frames);
+    for (size_t i = 0; i < frames; i++) {
+        _left[_frames + i] = in[2 * i];
+        _right[_frames + i] = in[2 * i + 1];
+    }
+    _frames += frames;
+}
+
+void Resampler::Process(float* out, size_t outFrames) {
+    outFrames = std::min(outFrames, MAX_OUTPUT_FRAMES);
+    for (size_t i = 0; i < outFrames; i++) {
+        size_t index = (size_t)_pos;
+        double phase = (_pos - (double)index) * PHASES;
+        size_t row = (size_t)phase;
+        float frac = (float)(phase - (double)row);
+
+        size_t first = index + 1 - TAPS / 2;
+        float left = 0.f;
+        float right = 0.f;
+        float deltaLeft = 0.f;
+        float deltaRight = 0.f;
+        kernels::Dot2(&_table[row * TAPS], &_left[first], &_right[first], TAPS, &left, &right);
+        kernels::Dot2(&_deltas[row * TAPS], &_left[first], &_right[first], TAPS, &deltaLeft, &deltaRight);
+        out[2 * i] = left + frac * deltaLeft;
+        out[2 * i + 1] = right + frac * deltaRight;
+        _pos += _step;
+    }
+
+    // Drop input that no output needs any more
+    size_t drop = std::min((size_t)_pos + 1 - TAPS / 2, _frames);
+    memmove(_left.data(), _left.data() + drop, (_frames - drop) * sizeof(float));
+    memmove(_right.data(), _right.data() + drop, (_frames - drop) * sizeof(float));
+    _frames -= drop;
+    _pos -= (double)drop;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// Stereo sample rate converter, windowed-sinc polyphase FIR. Converts the
+// engine's rate to the device's when they differ. Tables and buffers are
+// allocated in Init(), Push() and Process() don't allocate.
+class Resampler {
+public:
+    // Most output frames per Process() call
+    static constexpr size_t MAX_OUTPUT_FRAMES = 1024;
+
+    // outRateHz / inRateHz must be within [1/4, 4]
+    bool Init(float inRateHz, float outRateHz);
+
+    bool Active() const { return _step != 0.0; }
+    float OutputRateHz() const { return _outRateHz; }
+
+    // Input frames to Push() before Process() can make outFrames more
+    size_t InputNeeded(size_t outFrames) const;
+
+    // Append interleaved input
+    void Push(const float* in, size_t frames);
+
+    // Produce outFrames interleaved frames. Needs InputNeeded(outFrames)
+    // frames pushed first.
+    void Process(float* out, size_t outFrames);
+
+private:
+    static constexpr size_t TAPS = 32; // per phase, latency is TAPS / 2
+    static constexpr size_t PHASES = 256; // interpolated between
+    static constexpr double KAISER_BETA = 8.6; // about -90 dB stopband
+    static constexpr double PASSBAND = 0.9; // of the lower Nyquist
+
+    double _step = 0.0; // input frames per output frame
+    float _outRateHz = 0.f;
+
+    // PHASES rows of TAPS, row p is the filter for fractional position
+    // p / PHASES. _deltas holds the difference to the next row, so a
+    // position between rows is interpolated as
+    //   dot(row, x) + frac * dot(delta, x)
+    std::vector<float> _table;
+    std::vector<float> _deltas;
+
+    // Input history, deinterleaved. Output is centered on _pos.
+    std::vector<float> _left;
+    std::vector<float> _right;
+    size_t _frames = 0;
+    double _pos = 0.0;
+};
@@ -0,0 +1,98 @@
+#include "reverb.h"
+#include "utility.h"
+#include <SDL.h>
+#include <math.h>
+#include <algorithm>
+
+// Line lengths, spread out and with no common factors to speak of, so
+// their echoes rarely line up
+static constexpr float LINE_MS[kernels::FDN_LINES] = { 29.7f, 37.1f, 41.1f, 43.7f, 53.3f, 59.9f, 67.7f, 73.1f };
+
+// Signs of each line's share of the input and of each output. The two
+// outputs use orthogonal patterns so they're uncorrelated.
+static constexpr float INJECT_SIGNS[kernels::FDN_LINES] = { 1.f, -1.f, -1.f, 1.f, -1.f, 1.f, 1.f, -1.f };
+static constexpr float LEFT_SIGNS[kernels::FDN_LINES] = { 1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f };
+static constexpr float RIGHT_SIGNS[kernels::FDN_LINES] = { 1.f, 1.f, -1.f, -1.f, 1.f, 1.f, -1.f, -1.f };
+
+bool Reverb::Init(float sampleRateHz) {
+    _sampleRateHz = sampleRateHz;
+    for (size_t l = 0; l < LINES; l++) {
+        _lengths[l] = (size_t)lroundf(LINE_MS[l] / 1000.f * sampleRateHz);
+        if (_lengths[l] < BLOCK_FRAMES) {
+            SDL_Log("Reverb line %zu is shorter than a block at %.0f Hz", l, (double)sampleRateHz);
+            return false;
+        }
+        if (!_lines[l].Init(_lengths[l])) {
+            return false;
+        }
+        _fdn.inject[l] = 0.5f * INJECT_SIGNS[l];
+    }
+    _damping = -1.f; // coefficients are set on the first block
+    return true;
+}
+
+// A line of length L fed back with gain g decays by 20 * log10(g) dB every
+// L samples, so for -60 dB in decaySec, g = 10^(-3 * L / (decaySec * fs)).
+// Every line then decays at the same rate, whatever its length.
+void Reverb::UpdateCoeffs(const ReverbParams& params) {
+    float decaySec = utility::Clamp(params.decaySec, MIN_DECAY_SEC, MAX_DECAY_SEC);
+    float damping = utility::Clamp(params.damping, 0.f, 1.f);
+    if (decaySec == _decaySec && damping == _damping) {
+        return;
+    }
+    _decaySec = decaySec;
+    _damping = damping;
+
+    float norm = 1.f / sqrtf((float)LINES); // Hadamard matrix scale
+    float cutoffHz = MAX_DAMPING_HZ * powf(MIN_DAMPING_HZ / MAX_DAMPING_HZ, damping);
+    cutoffHz = std::min(cutoffHz, 0.45f * _sampleRateHz);
+    float c = 1.f - expf(-TWOPI * cutoffHz / _sampleRateHz);
+    for (size_t l = 0; l < LINES; l++) {
+        _fdn.gain[l] = norm * powf(10.f, -3.f * (float)_lengths[l] / (decaySec * _sampleRateHz));
+        _fdn.c[l] = c;
+    }
+}
+
+void Reverb::Process(const ReverbParams& params, float* left, float* right, size_t n) {
+    if (!_active) {
+        if (!params.enabled) {
+            return;
+        }
+        for (DelayLine& line : _lines) {
+            line.Clear();
+        }
+        for (float& lp : _fdn.lp) {
+            lp = 0.f;
+        }
+        _active = true;
+        _mix = 0.f;
+    }
+    UpdateCoeffs(params);
+    float mix = (params.enabled ? utility::Clamp(params.mix, 0.f, 1.f) : 0.f);
+
+    for (size_t i = 0; i < n; i++) {
+        _in[i] = 0.5f * (left[i] + right[i]);
+    }
+    for (size_t l = 0; l < LINES; l++) {
+        _lines[l].Read(_lengths[l], _rows[l], n);
+    }
+
+    // Outputs first, the network overwrites the rows with its feedback
+    float norm = 1.f / sqrtf((float)LINES);
+    for (size_t l = 0; l < LINES; l++) {
+        float gainLeft = norm * LEFT_SIGNS[l];
+        float gainRight = norm * RIGHT_SIGNS[l];
+        kernels::AddRamp(_rows[l], left, gainLeft * _mix, gainLeft * mix, n);
+        kernels::AddRamp(_rows[l], right, gainRight * _mix, gainRight * mix, n);
+    }
+
+    kernels::Fdn(&_fdn, _rows[0], BLOCK_FRAMES, _in, n);
+    for (size_t l = 0; l < LINES; l++) {
+        _lines[l].Write(_rows[l], n);
+    }
+
+    _mix = mix;
+    if (!params.enabled) {
+        _active = false;
+    }
+}
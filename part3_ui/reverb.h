@@ -0,0 +1,52 @@
+#pragma once
+
+#include "delay.h"
+#include "kernels.h"
+#include "constants.h"
+#include <stddef.h>
+
+struct ReverbParams {
+    bool enabled = false;
+    float decaySec = 2.f; // time to fall by 60 dB, range [MIN_DECAY_SEC, MAX_DECAY_SEC]
+    float damping = 0.5f; // high frequencies die away faster, range [0, 1]
+    float mix = 0.25f; // wet level added to the dry signal, range [0, 1]
+};
+
+// Feedback delay network reverb: 8 delay lines of unrelated lengths, fed
+// back through a lowpass and a Hadamard matrix so each echo spreads into
+// all the others. The lines run side by side, one per SIMD lane (see
+// kernels::Fdn). Every line is longer than a block, so a whole block of
+// each one's output is read before any of it is written back. Bypassed
+// the same way as StereoDelay.
+class Reverb {
+public:
+    static constexpr float MIN_DECAY_SEC = 0.2f;
+    static constexpr float MAX_DECAY_SEC = 20.f;
+
+    bool Init(float sampleRateHz);
+
+    // n <= BLOCK_FRAMES, in place
+    void Process(const ReverbParams& params, float* left, float* right, size_t n);
+
+private:
+    static constexpr size_t LINES = kernels::FDN_LINES;
+    static constexpr float MAX_DAMPING_HZ = 20000.f; // damping 0
+    static constexpr float MIN_DAMPING_HZ = 1000.f; // damping 1
+
+    // Sets the feedback gains and lowpass when the knobs move
+    void UpdateCoeffs(const ReverbParams& params);
+
+    DelayLine _lines[LINES];
+    size_t _lengths[LINES] = {};
+    float _sampleRateHz = 0.f;
+
+    kernels::FdnLanes _fdn = {};
+    float _decaySec = 0.f;
+    float _damping = -1.f;
+
+    bool _active = false;
+    float _mix = 0.f;
+
+    alignas(32) float _rows[LINES][BLOCK_FRAMES];
+    alignas(32) float _in[BLOCK_FRAMES];
+};
@@ -0,0 +1,370 @@
+#include "sampler.h"
+#include "kernels.h"
+#include "voice.h"
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#ifndef IS_WASM_BUILD
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-----------------------
+// MappedFile
+//-----------------------
+
+MappedFile::~MappedFile() {
+#ifndef IS_WASM_BUILD
+    if (_data != nullptr) {
+        munmap((void*)_data, _size);
+    }
+#endif
+}
+
+#ifdef IS_WASM_BUILD
+
+bool MappedFile::Open(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        SDL_Log("Could not open %s", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    _bytes.resize(size > 0 ? (size_t)size : 0);
+    bool ok = (size > 0 && fread(_bytes.data(), 1, _bytes.size(), file) == _bytes.size());
+    fclose(file);
+    if (!ok) {
+        SDL_Log("Could not read %s", path);
+        return false;
+    }
+    _data = _bytes.data();
+    _size = _bytes.size();
+    return true;
+}
+
+void MappedFile::WillNeed(size_t, size_t) const {}
+void MappedFile::DontNeed(size_t, size_t) const {}
+
+#else
+
+bool MappedFile::Open(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        SDL_Log("Could not open %s", path);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        SDL_Log("Could not read %s", path);
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)info.st_size;
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (data == MAP_FAILED) {
+        SDL_Log("Could not map %s", path);
+        return false;
+    }
+    _data = (const uint8_t*)data;
+    _size = size;
+    return true;
+}
+
+static size_t PageBytes() {
+    static const size_t pageBytes = (size_t)sysconf(_SC_PAGESIZE);
+    return pageBytes;
+}
+
+void MappedFile::WillNeed(size_t offset, size_t bytes) const {
+    size_t begin = offset & ~(PageBytes() - 1);
+    size_t end = std::min(offset + bytes, _size);
+    if (end > begin) {
+        madvise((void*)(_data + begin), end - begin, MADV_WILLNEED);
+    }
+}
+
+void MappedFile::DontNeed(size_t offset, size_t bytes) const {
+    size_t begin = offset & ~(PageBytes() - 1);
+    size_t end = std::min(offset + bytes, _size) & ~(PageBytes() - 1);
+    if (end > begin) {
+        madvise((void*)(_data + begin), end - begin, MADV_DONTNEED);
+    }
+}
+
+#endif // IS_WASM_BUILD
+
+//-----------------------
+// Loading
+//-----------------------
+
+Sampler::~Sampler() {
+    _stop.store(true, std::memory_order_relaxed);
+    if (_streamer.joinable()) {
+        _streamer.join();
+    }
+}
+
+bool Sampler::Load(const char* keymapPath, bool threaded) {
+#ifdef IS_WASM_BUILD
+    threaded = false; // no threads in the browser build
+#endif
+    FILE* file = fopen(keymapPath, "r");
+    if (file == nullptr) {
+        SDL_Log("Could not open keymap %s", keymapPath);
+        return false;
+    }
+    std::string dir = keymapPath;
+    dir.erase(dir.find_last_of('/') == std::string::npos ? 0 : dir.find_last_of('/') + 1);
+
+    uint32_t startMs = SDL_GetTicks();
+    char line[1024];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        uint32_t note = 0;
+        char path[1024] = {};
+        int fields = sscanf(line, "%u %1023[^\r\n]", &note, path);
+        if (fields <= 0) {
+            continue; // blank line
+        }
+        // Paths may have spaces, but not trailing ones
+        for (size_t len = strlen(path); len > 0 && (path[len - 1] == ' ' || path[len - 1] == '\t'); len--) {
+            path[len - 1] = '\0';
+        }
+        if (fields != 2 || note >= NUM_KEYS) {
+            SDL_Log("%s:%d: expected <note> <path>", keymapPath, lineNumber);
+            ok = false;
+            break;
+        }
+        std::string fullPath = (path[0] == '/' ? std::string(path) : dir + path);
+        ok = LoadZone((uint8_t)note, fullPath.c_str());
+    }
+    fclose(file);
+    if (!ok) {
+        _zones.clear();
+        return false;
+    }
+    if (_zones.empty()) {
+        SDL_Log("No samples in keymap %s", keymapPath);
+        return false;
+    }
+
+    // Nearest root, the lower one on a tie
+    for (uint8_t note = 0; note < NUM_KEYS; note++) {
+        uint16_t best = 0;
+        for (uint16_t z = 1; z < _zones.size(); z++) {
+            int distance = abs((int)_zones[z].rootNote - (int)note);
+            int bestDistance = abs((int)_zones[best].rootNote - (int)note);
+            if (distance < bestDistance || (distance == bestDistance && _zones[z].rootNote < _zones[best].rootNote)) {
+                best = z;
+            }
+        }
+        _zoneForNote[note] = best;
+    }
+
+    size_t headBytes = 0;
+    for (const Zone& zone : _zones) {
+        headBytes += zone.head.size() * sizeof(float);
+    }
+    for (Stream& stream : _streams) {
+        stream.ring.assign(RING_FRAMES, 0.f);
+        stream.window.assign(WINDOW_FRAMES, 0.f);
+    }
+    size_t streamBytes = _streams.size() * (RING_FRAMES + WINDOW_FRAMES) * sizeof(float);
+    SDL_Log("Loaded %zu samples in %u ms, %.1f MB of heads, %.1f MB of stream buffers",
+            _zones.size(), SDL_GetTicks() - startMs, (double)headBytes / 1e6, (double)streamBytes / 1e6);
+
+    _threaded = threaded;
+    if (_threaded) {
+        _streamer = std::thread(&Sampler::StreamLoop, this);
+    }
+    return true;
+}
+
+bool Sampler::LoadZone(uint8_t rootNote, const char* path) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->Open(path)) {
+        return false;
+    }
+    Zone zone;
+    if (!ParseWavHeader(file->Data(), file->Size(), &zone.format) || zone.format.frames == 0) {
+        SDL_Log("Could not load %s", path);
+        return false;
+    }
+    zone.rootNote = rootNote;
+    zone.rootFreqHz = 27.5f * exp2f((float)rootNote / 12.f); // A0 up
+    zone.sampleRateHz = (float)zone.format.sampleRateHz;
+    zone.frames = zone.format.frames;
+
+    // One read-ahead for the whole head rather than a fault per page. Once
+    // decoded, its pages can go.
+    size_t headFrames = std::min(zone.frames, HEAD_FRAMES);
+    size_t headEnd = zone.format.dataOffset + headFrames * zone.format.BytesPerFrame();
+    file->WillNeed(0, headEnd);
+    zone.head.resize(headFrames);
+    DecodeWavMono(zone.format, file->Data(), 0, headFrames, zone.head.data());
+    file->DontNeed(0, headEnd);
+    if (zone.frames > headFrames) {
+        zone.file = std::move(file); // otherwise unmapped here
+    }
+    _zones.push_back(std::move(zone));
+    return true;
+}
+
+//-----------------------
+// Streaming
+//-----------------------
+
+void Sampler::StreamLoop() {
+    while (!_stop.load(std::memory_order_relaxed)) {
+        for (Stream& stream : _streams) {
+            FillStream(stream);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(STREAM_PERIOD_MS));
+    }
+}
+
+// Only ever called from one thread at a time: the streamer, or in an
+// offline render the thread rendering the voice
+void Sampler::FillStream(Stream& stream) {
+    uint64_t request = stream.request.load(std::memory_order_acquire);
+    uint32_t zoneIndex = (uint32_t)request;
+    if (zoneIndex == 0) {
+        return;
+    }
+    const Zone& zone = _zones[zoneIndex - 1];
+    if (!zone.file) {
+        return; // all in the head
+    }
+    uint64_t generation = request >> 32;
+    uint64_t consumedWord = stream.consumed.load(std::memory_order_acquire);
+    if ((consumedWord >> 32) != generation) {
+        return; // restarted since, catch it next time
+    }
+    uint64_t writtenWord = stream.written.load(std::memory_order_relaxed);
+    size_t consumed = (uint32_t)consumedWord;
+    size_t done = ((writtenWord >> 32) == generation ? (uint32_t)writtenWord : 0);
+    done = std::max(done, consumed); // the voice ran past the stream, skip ahead
+
+    size_t headFrames = zone.head.size();
+    size_t total = zone.frames - headFrames;
+    size_t bytesPerFrame = zone.format.BytesPerFrame();
+    while (done < total && done - consumed < RING_FRAMES) {
+        size_t start = done & (RING_FRAMES - 1);
+        size_t count = std::min({ STREAM_CHUNK_FRAMES, total - done, RING_FRAMES - (done - consumed), RING_FRAMES - start });
+        size_t frame = headFrames + done;
+        DecodeWavMono(zone.format, zone.file->Data(), frame, count, &stream.ring[start]);
+        zone.file->DontNeed(zone.format.dataOffset + frame * bytesPerFrame, count * bytesPerFrame);
+        done += count;
+        stream.written.store((generation << 32) | done, std::memory_order_release);
+    }
+}
+
+//-----------------------
+// Playback
+//-----------------------
+
+void Sampler::StartNote(Voice& voice, Stream& stream) {
+    uint64_t generation = (stream.request.load(std::memory_order_relaxed) >> 32) + 1;
+    uint16_t zone = _zoneForNote[voice.note];
+    stream.consumed.store(generation << 32, std::memory_order_relaxed);
+    stream.request.store((generation << 32) | (uint64_t)(zone + 1), std::memory_order_release);
+    voice.sampleZone = zone;
+    voice.samplePosition = 0;
+    voice.sampleStarted = true;
+}
+
+bool Sampler::ReadFrames(const Zone& zone, Stream& stream, int64_t first, size_t count, float* out) const {
+    int64_t end = first + (int64_t)count;
+    int64_t headFrames = (int64_t)zone.head.size();
+    int64_t frames = (int64_t)zone.frames;
+    uint64_t generation = stream.request.load(std::memory_order_relaxed) >> 32;
+    uint64_t writtenWord = stream.written.load(std::memory_order_acquire);
+    int64_t available = headFrames + ((writtenWord >> 32) == generation ? (int64_t)(uint32_t)writtenWord : 0);
+
+    bool complete = true;
+    int64_t f = first;
+    while (f < end) {
+        if (f < 0 || f >= frames) {
+            int64_t until = (f < 0 ? std::min(end, (int64_t)0) : end);
+            std::fill(out + (f - first), out + (until - first), 0.f);
+            f = until;
+        } else if (f < headFrames) {
+            int64_t until = std::min(end, headFrames);
+            std::copy(zone.head.data() + f, zone.head.data() + until, out + (f - first));
+            f = until;
+        } else if (f < available) {
+            size_t start = (size_t)(f - headFrames) & (RING_FRAMES - 1);
+            int64_t until = std::min({ end, available, frames, f + (int64_t)(RING_FRAMES - start) });
+            std::copy(stream.ring.data() + start, stream.ring.data() + start + (until - f), out + (f - first));
+            f = until;
+        } else {
+            int64_t until = std::min(end, frames);
+            std::fill(out + (f - first), out + (until - first), 0.f);
+            f = until;
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+void Sampler::Render(Voice& voice, float freqHz, float renderRateHz, float* out, size_t frames) {
+    if (!Loaded()) {
+        std::fill(out, out + frames, 0.f);
+        return;
+    }
+    Stream& stream = _streams[voice.index];
+    if (!voice.sampleStarted) {
+        StartNote(voice, stream);
+    }
+    if (!_threaded) {
+        FillStream(stream);
+    }
+    const Zone& zone = _zones[voice.sampleZone];
+
+    float step = std::min(freqHz / zone.rootFreqHz * zone.sampleRateHz / renderRateHz, MAX_STEP);
+    uint32_t increment = (uint32_t)lroundf(step * (float)(1u << FRAC_BITS));
+    uint64_t position = voice.samplePosition;
+    voice.samplePosition = position + frames * increment;
+
+    // Input from one frame before the first position, for the
+    // interpolation, to two after the last
+    int64_t first = (int64_t)(position >> FRAC_BITS) - 1;
+    if (first >= (int64_t)zone.frames) {
+        std::fill(out, out + frames, 0.f); // played out
+        return;
+    }
+    int64_t last = (int64_t)((position + (frames - 1) * increment) >> FRAC_BITS);
+    size_t count = (size_t)(last + 3 - first);
+    uint32_t start = (uint32_t)(position - ((uint64_t)(first + 1) << FRAC_BITS));
+    const float* in = stream.window.data();
+    if (first >= 0 && first + (int64_t)count <= (int64_t)zone.head.size()) {
+        in = zone.head.data() + first; // all in the head, no copy
+    } else if (!ReadFrames(zone, stream, first, count, stream.window.data())) {
+        _underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    kernels::Resample(in + 1, start, increment, FRAC_BITS, out, frames);
+
+    // The stream can reuse everything before the next block's first frame
+    if (zone.file) {
+        int64_t next = (int64_t)(voice.samplePosition >> FRAC_BITS) - 1;
+        uint64_t consumed = (uint64_t)std::max(next - (int64_t)zone.head.size(), (int64_t)0);
+        uint64_t generation = stream.request.load(std::memory_order_relaxed) >> 32;
+        stream.consumed.store((generation << 32) | std::min(consumed, (uint64_t)UINT32_MAX), std::memory_order_release);
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "constants.h"
+#include "oversampler.h"
+#include "wav.h"
+#include <atomic>
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+struct Voice;
+
+// A whole file mapped read-only. Pages are read from disk when first
+// touched and can be dropped again once used, so a large file costs
+// address space but not memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool Open(const char* path);
+
+    const uint8_t* Data() const { return _data; }
+    size_t Size() const { return _size; }
+
+    // Paging hints for [offset, offset + bytes): read ahead now, and done
+    // with for a while. Dropped pages stay in the OS file cache. A page
+    // the range ends partway into is kept, it holds data still to be read.
+    void WillNeed(size_t offset, size_t bytes) const;
+    void DontNeed(size_t offset, size_t bytes) const;
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+#ifdef IS_WASM_BUILD
+    std::vector<uint8_t> _bytes; // no mmap in the browser, read in whole
+#endif
+};
+
+// Multisampled instrument played from .wav files, one of the oscillator
+// sources next to the wavetables. Samples play once from the top, mixed
+// to mono, and stop at their end.
+//
+// Loading reads each file's header and its first HEAD_FRAMES, decoded to
+// float and kept in memory, so notes start without touching the disk on
+// the audio thread. Files that fit in the head are closed straight away.
+// The rest of a longer sample is streamed while it plays: a background
+// thread decodes it from the mapped file into the voice's ring buffer,
+// ahead of the audio thread, and drops the pages once read. Load time
+// and memory grow with the number of samples rather than their length.
+//
+// A voice that catches up with its stream plays silence until the stream
+// gets ahead again, counted in Underruns(). Offline renders stream on the
+// rendering thread instead, so their output doesn't depend on timing.
+//
+// The keymap is a text file, one sample per line, '#' starts a comment:
+//   <note> <path>   note the sample was recorded at, 0-based on the 88-key
+//                   piano, and the .wav file relative to the keymap
+// Each key plays the sample recorded nearest to it, repitched.
+class Sampler {
+public:
+    static constexpr size_t HEAD_FRAMES = 1 << 15;
+    static constexpr size_t RING_FRAMES = 1 << 15; // per voice
+    static constexpr size_t STREAM_CHUNK_FRAMES = 4096;
+    static constexpr uint32_t STREAM_PERIOD_MS = 2;
+
+    // Sample frames per output frame. Higher notes are held at this pitch,
+    // which bounds how much of a sample one block reads.
+    static constexpr float MAX_STEP = 16.f;
+
+    ~Sampler();
+
+    // Main thread, before audio starts. With threaded false, samples are
+    // streamed from Render() instead of a background thread.
+    bool Load(const char* keymapPath, bool threaded);
+
+    bool Loaded() const { return !_zones.empty(); }
+
+    // Audio thread, or the worker rendering the voice. Write frames of the
+    // voice's note at freqHz for an output at renderRateHz, starting the
+    // note from the top of its sample if it was just triggered. Silence if
+    // nothing is loaded.
+    void Render(Voice& voice, float freqHz, float renderRateHz, float* out, size_t frames);
+
+    uint64_t Underruns() const { return _underruns.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t FRAC_BITS = 18; // of sample positions, see kernels::Resample()
+    static constexpr size_t WINDOW_FRAMES = (size_t)MAX_STEP * BLOCK_FRAMES * Oversampler::MAX_FACTOR + 4;
+
+    // One sample, played for the keys nearest its root note
+    struct Zone {
+        uint8_t rootNote = 0;
+        float rootFreqHz = 0.f;
+        float sampleRateHz = 0.f;
+        size_t frames = 0;
+        std::vector<float> head; // first min(frames, HEAD_FRAMES)
+        WavFormat format;
+        std::unique_ptr<MappedFile> file; // longer samples only, for streaming
+    };
+
+    // The part of a voice's sample past the head, streamed into a ring.
+    // The audio thread bumps the generation each time the voice starts a
+    // note. The counters carry the generation in their top 32 bits, so
+    // each side ignores the other's progress on an old note.
+    struct alignas(64) Stream {
+        std::vector<float> ring; // RING_FRAMES
+        std::vector<float> window; // input for one block, audio thread only
+        std::atomic<uint64_t> request{0}; // generation, zone + 1 (0 idle). Audio thread.
+        std::atomic<uint64_t> consumed{0}; // generation, frames done with. Audio thread.
+        std::atomic<uint64_t> written{0}; // generation, frames decoded. Streamer.
+    };
+
+    bool LoadZone(uint8_t rootNote, const char* path);
+    void StartNote(Voice& voice, Stream& stream);
+    void FillStream(Stream& stream);
+    void StreamLoop();
+
+    // Frames [first, first + count) of the note's sample into out, zeros
+    // outside the sample. False if the stream hasn't got that far yet.
+    bool ReadFrames(const Zone& zone, Stream& stream, int64_t first, size_t count, float* out) const;
+
+    std::vector<Zone> _zones;
+    std::array<uint16_t, NUM_KEYS> _zoneForNote = {};
+    std::array<Stream, MAX_VOICES> _streams;
+    bool _threaded = false;
+
+    std::thread _streamer;
+    std::atomic<bool> _stop{false};
+    std::atomic<uint64_t> _underruns{0};
+};
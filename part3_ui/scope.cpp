@@ -0,0 +1,55 @@
+#include "scope.h"
+#include <algorithm>
+
+void Scope::Update(AudioTap* tap) {
+    // Pop straight into the ring, at most up to its end each time
+    while (true) {
+        size_t pos = _written & (HISTORY - 1);
+        size_t popped = tap->TryPop(&_history[pos], HISTORY - pos);
+        _written += popped;
+        if (popped == 0) {
+            return;
+        }
+    }
+}
+
+bool Scope::Trace(float* mins, float* maxs, size_t columns) const {
+    if (_written < WINDOW) {
+        return false;
+    }
+
+    // Latest rising zero crossing that still leaves a full window after
+    // it. Free-run on the newest window if there isn't one.
+    size_t newest = _written - WINDOW;
+    size_t oldest = (_written > HISTORY ? _written - HISTORY : 0);
+    size_t start = newest;
+    for (size_t i = newest; i > oldest; i--) {
+        if (Sample(i - 1) < 0.f && Sample(i) >= 0.f) {
+            start = i;
+            break;
+        }
+    }
+
+    float peak = 0.f;
+    for (size_t c = 0; c < columns; c++) {
+        size_t begin = start + c * WINDOW / columns;
+        size_t end = start + (c + 1) * WINDOW / columns;
+        float lo = Sample(begin);
+        float hi = lo;
+        for (size_t i = begin + 1; i < end; i++) {
+            lo = std::min(lo, Sample(i));
+            hi = std::max(hi, Sample(i));
+        }
+        mins[c] = lo;
+        maxs[c] = hi;
+        peak = std::max(peak, std::max(-lo, hi));
+    }
+    return (peak > SILENCE);
+}
+
+void Scope::Latest(float* out, size_t n) const {
+    size_t start = _written - n; // wraps harmlessly before HISTORY samples
+    for (size_t i = 0; i < n; i++) {
+        out[i] = Sample(start + i);
+    }
+}
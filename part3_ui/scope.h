@@ -0,0 +1,37 @@
+#pragma once
+
+#include "spsc_queue.h"
+#include <array>
+#include <stddef.h>
+
+// Mono mix of the rendered output, audio thread -> UI. The audio thread
+// drops samples rather than wait when the UI falls behind.
+using AudioTap = SpscQueue<float, 8192>;
+
+// UI side of the audio tap. Keeps the most recent output and turns it into
+// a stable, triggered trace that is cheap to draw.
+class Scope {
+public:
+    static constexpr size_t WINDOW = 2048; // samples shown
+
+    // Pull everything new from the tap. Call once per UI frame.
+    void Update(AudioTap* tap);
+
+    // Min and max of each of columns equal slices of the last WINDOW
+    // samples, starting at a rising zero crossing so periodic signals
+    // stand still. Returns false if the output is silent.
+    bool Trace(float* mins, float* maxs, size_t columns) const;
+
+    // Copy the newest n samples, oldest first. n must be <= HISTORY.
+    void Latest(float* out, size_t n) const;
+
+    static constexpr size_t HISTORY = 2 * WINDOW; // power of 2
+
+private:
+    static constexpr float SILENCE = 1e-4f;
+
+    float Sample(size_t i) const { return _history[i & (HISTORY - 1)]; }
+
+    std::array<float, HISTORY> _history = {};
+    size_t _written = 0; // total samples received
+};
@@ -95,29 +95,38 @@ bool SDLWrapper::InitAudio(uint32_t sampleRateHz, uint16_t samplesPerBuffer, SDL
     desired.userdata = callbackUserdata;
 
     SDL_AudioSpec actual = {};
-    _audioDevice = SDL_OpenAudioDevice(NULL, 0, &desired, &actual, 0);
+    // Any period and rate are fine, the engine adapts to them. Take what
+    // the driver prefers rather than have SDL rebuffer and resample.
+    _audioDevice = SDL_OpenAudioDevice(NULL, 0, &desired, &actual,
+            SDL_AUDIO_ALLOW_SAMPLES_CHANGE | SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
     if (_audioDevice <= 0) {
         SDL_Log("Could not open audio device: %s", SDL_GetError());
         return false;
     }
-    if ((desired.format != actual.format) || (desired.samples != actual.samples)) {
+    if (desired.format != actual.format) {
         SDL_Log("Could not get desired audio format");
         return false;
     }
 
     SDL_Log("-------------------");
-    SDL_Log("sample rate: %d", actual.freq);
+    SDL_Log("sample rate: %d (asked for %d)", actual.freq, desired.freq);
     SDL_Log("channels:    %d", actual.channels);
-    SDL_Log("samples:     %d", actual.samples);
+    SDL_Log("samples:     %d (asked for %d)", actual.samples, desired.samples);
     SDL_Log("size:        %d", actual.size);
     SDL_Log("------------------");
 
-    SDL_PauseAudioDevice(_audioDevice, 0);
+    _audioSpec = actual;
     return true;
 }
 
+void SDLWrapper::StartAudio() {
+    SDL_PauseAudioDevice(_audioDevice, 0);
+}
+
 SDLWrapper::~SDLWrapper() {
-    SDL_CloseAudioDevice(_audioDevice);
+    if (_audioDevice > 0) {
+        SDL_CloseAudioDevice(_audioDevice);
+    }
     if (_gl_context) {
         SDL_GL_DeleteContext(_gl_context);
     }
@@ -17,6 +17,11 @@ public:
         SDL_AudioCallback audioCallback,
         void* callbackUserdata);
 
+    // Audio device is opened paused, so the engine can be set up for the
+    // rate it got before the callback runs
+    float AudioSampleRateHz() const { return (float)_audioSpec.freq; }
+    void StartAudio();
+
     SDL_GLContext _gl_context = nullptr;
     SDL_Window* _window = nullptr;
 
@@ -25,5 +30,6 @@ private:
     bool InitRenderer(uint32_t widthPx, uint32_t heightPx);
     bool InitAudio(uint32_t sampleRateHz, uint16_t samplesPerBuffer, SDL_AudioCallback audioCallback, void* callbackUserdata);
 
-    SDL_AudioDeviceID _audioDevice;
+    SDL_AudioDeviceID _audioDevice = 0;
+    SDL_AudioSpec _audioSpec = {};
 };
@@ -0,0 +1,61 @@
+#include "spectrum.h"
+#include "constants.h"
+#include "utility.h"
+#include <math.h>
+#include <algorithm>
+
+bool Spectrum::Init(float sampleRateHz) {
+    if (!_fft.Init(FFT_SIZE)) {
+        return false;
+    }
+
+    // Coherent gain of a Hann window is 1/2, and a sine's energy is split
+    // between the positive and negative bins, so scale by 4 / N
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        float hann = 0.5f - 0.5f * cosf(TWOPI * (float)i / (float)FFT_SIZE);
+        _window[i] = hann * 4.f / (float)FFT_SIZE;
+    }
+
+    // Log-spaced band edges. Low bands narrower than a bin get one bin.
+    float binHz = sampleRateHz / (float)FFT_SIZE;
+    for (size_t b = 0; b <= NUM_BANDS; b++) {
+        float hz = MIN_HZ * powf(MAX_HZ / MIN_HZ, (float)b / (float)NUM_BANDS);
+        size_t bin = (size_t)lroundf(hz / binHz);
+        if (b > 0) {
+            bin = std::max(bin, _bandStart[b - 1] + 1);
+        }
+        _bandStart[b] = std::min(bin, NUM_BINS - 1);
+    }
+
+    _levels.fill(MIN_DB);
+    _peaks.fill(MIN_DB);
+    return true;
+}
+
+void Spectrum::Update(const Scope& scope, uint32_t nowMs) {
+    float dtSec = (float)(nowMs - _lastMs) / 1000.f;
+    _lastMs = nowMs;
+
+    scope.Latest(_samples.data(), FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; i++) {
+        _samples[i] *= _window[i];
+    }
+    _fft.Forward(_samples.data(), _re.data(), _im.data());
+
+    for (size_t b = 0; b < NUM_BANDS; b++) {
+        // Strongest bin in the band, so a single partial reads at its level
+        float power = 0.f;
+        for (size_t k = _bandStart[b]; k < std::max(_bandStart[b + 1], _bandStart[b] + 1); k++) {
+            power = std::max(power, _re[k] * _re[k] + _im[k] * _im[k]);
+        }
+        float db = 10.f * log10f(std::max(power, 1e-12f));
+        _levels[b] = utility::Clamp(db, MIN_DB, MAX_DB);
+
+        if (_levels[b] >= _peaks[b]) {
+            _peaks[b] = _levels[b];
+            _peakMs[b] = nowMs;
+        } else if (nowMs - _peakMs[b] > PEAK_HOLD_MS) {
+            _peaks[b] = std::max(_levels[b], _peaks[b] - PEAK_FALL_DB_PER_SEC * dtSec);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "fft.h"
+#include "scope.h"
+#include <array>
+#include <stddef.h>
+
+// Spectrum analyzer, run on the UI thread from the scope history. Levels
+// are in dB over log-spaced bands, with a falling peak hold.
+class Spectrum {
+public:
+    static constexpr size_t FFT_SIZE = 2048;
+    static constexpr size_t NUM_BANDS = 48;
+    static constexpr float MIN_HZ = 20.f;
+    static constexpr float MAX_HZ = 20000.f;
+    static constexpr float MIN_DB = -90.f;
+    static constexpr float MAX_DB = 0.f;
+
+    bool Init(float sampleRateHz);
+
+    // Analyze the newest FFT_SIZE samples. Call once per UI frame.
+    void Update(const Scope& scope, uint32_t nowMs);
+
+    // In dB, range [MIN_DB, MAX_DB]
+    float Level(size_t band) const { return _levels[band]; }
+    float Peak(size_t band) const { return _peaks[band]; }
+
+private:
+    static constexpr size_t NUM_BINS = FFT_SIZE / 2 + 1;
+    static constexpr uint32_t PEAK_HOLD_MS = 800;
+    static constexpr float PEAK_FALL_DB_PER_SEC = 30.f;
+
+    Fft _fft;
+    std::array<float, FFT_SIZE> _window = {}; // Hann, scaled so a full scale sine is 0 dB
+    std::array<float, FFT_SIZE> _samples = {};
+    std::array<float, NUM_BINS> _re = {};
+    std::array<float, NUM_BINS> _im = {};
+
+    // FFT bins [_bandStart[b], _bandStart[b + 1]) make up band b
+    std::array<size_t, NUM_BANDS + 1> _bandStart = {};
+
+    std::array<float, NUM_BANDS> _levels = {};
+    std::array<float, NUM_BANDS> _peaks = {};
+    std::array<uint32_t, NUM_BANDS> _peakMs = {}; // when each peak was set
+    uint32_t _lastMs = 0;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <array>
+#include <stddef.h>
+
+// Wait-free, fixed-capacity single-producer/single-consumer queue. One
+// thread may push and one other thread may peek/pop. Never allocates.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+    // Producer. Returns false if the queue is full.
+    bool TryPush(const T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        _items[tail & (Capacity - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer. Push as many of count items as fit, returns the number
+    // pushed.
+    size_t TryPush(const T* items, size_t count) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        count = std::min(count, Capacity - (tail - _head.load(std::memory_order_acquire)));
+        for (size_t i = 0; i < count; i++) {
+            _items[(tail + i) & (Capacity - 1)] = items[i];
+        }
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Producer. True if TryPush() would fail.
+    bool Full() const {
+        return (_tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_acquire) == Capacity);
+    }
+
+    // Consumer. Front item, or nullptr if empty. Stays queued until Pop().
+    const T* Peek() const {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &_items[head & (Capacity - 1)];
+    }
+
+    // Consumer. Only valid after Peek() returned an item.
+    void Pop() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer. Returns false if the queue is empty.
+    bool TryPop(T* item) {
+        const T* front = Peek();
+        if (front == nullptr) {
+            return false;
+        }
+        *item = *front;
+        Pop();
+        return true;
+    }
+
+    // Consumer. Pop up to count items, returns the number popped.
+    size_t TryPop(T* items, size_t count) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        count = std::min(count, _tail.load(std::memory_order_acquire) - head);
+        for (size_t i = 0; i < count; i++) {
+            items[i] = _items[(head + i) & (Capacity - 1)];
+        }
+        _head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    // Separate cache lines so producer and consumer don't false-share
+    alignas(64) std::atomic<size_t> _head{0}; // written by consumer
+    alignas(64) std::atomic<size_t> _tail{0}; // written by producer
+    alignas(64) std::array<T, Capacity> _items = {};
+};
@@ -2,14 +2,37 @@
 
 #include "sdlwrapper.h"
 #include "oscillator.h"
+#include "sampler.h"
+#include "voice.h"
+#include "modmatrix.h"
+#include "effects.h"
+#include "patch.h"
+#include "midifile.h"
+#include "event.h"
+#include "dspload.h"
+#include "resampler.h"
+#include "scope.h"
+#include "worker_pool.h"
 #include "ui.h"
 #include "input.h"
 #include "constants.h"
 
 struct Synth {
     bool running = true;
+    float sampleRateHz = DEFAULT_SAMPLE_RATE_HZ; // engine rate, fixed once audio starts
+    Resampler resampler; // engine rate -> device rate, if they differ
+    WorkerPool workers; // declared before sdl so it outlives the audio device
+    Sampler sampler; // likewise
     SDLWrapper sdl;
     Input input;
     Oscillator osc;
+    VoicePool voices;
+    mod::Matrix mod; // edited on the UI thread, read by the audio thread
+    Effects effects; // after the voices are mixed
+    PatchSwap patches; // whole patches, UI thread -> audio thread
+    MidiPlayer player; // song, played by the audio thread
+    EventQueue events; // UI thread -> audio thread
+    AudioTap tap; // audio thread -> UI thread
+    DspLoad dspLoad;
     UI ui;
 };
@@ -0,0 +1,164 @@
+#include "trace.h"
+#include <SDL.h>
+
+#ifdef SYNTH_TRACE
+
+#include "spsc_queue.h"
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace trace {
+
+static constexpr uint32_t MAX_THREADS = 8;
+static constexpr size_t RECORDS_PER_THREAD = 8192;
+static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(20);
+
+struct Record {
+    const char* name;
+    uint64_t start; // performance counter ticks
+    uint64_t end;
+};
+
+struct ThreadBuffer {
+    SpscQueue<Record, RECORDS_PER_THREAD> records; // zone thread -> flush thread
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint32_t> dropped{0};
+};
+
+// All buffers exist up front, a thread claims one on its first zone
+static ThreadBuffer _buffers[MAX_THREADS];
+static std::atomic<uint32_t> _numBuffers{0};
+static thread_local ThreadBuffer* _threadBuffer = nullptr;
+static thread_local bool _threadBufferClaimed = false;
+
+static std::atomic<bool> _enabled{false};
+static FILE* _file = nullptr;
+static std::thread _flushThread;
+static std::atomic<bool> _flushRunning{false};
+static uint64_t _startTicks = 0;
+static double _usPerTick = 0.0;
+static bool _firstEvent = true;
+
+static ThreadBuffer* GetThreadBuffer() {
+    if (!_threadBufferClaimed) {
+        _threadBufferClaimed = true;
+        uint32_t index = _numBuffers.fetch_add(1, std::memory_order_acq_rel);
+        _threadBuffer = (index < MAX_THREADS ? &_buffers[index] : nullptr);
+    }
+    return _threadBuffer;
+}
+
+Zone::Zone(const char* name) : _name(name), _start(0) {
+    if (_enabled.load(std::memory_order_relaxed)) {
+        _start = SDL_GetPerformanceCounter();
+    }
+}
+
+Zone::~Zone() {
+    if (_start == 0) {
+        return;
+    }
+    ThreadBuffer* buffer = GetThreadBuffer();
+    if (buffer && !buffer->records.TryPush({ _name, _start, SDL_GetPerformanceCounter() })) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void NameThread(const char* name) {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    if (buffer) {
+        buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+static void WriteSeparator() {
+    fputs(_firstEvent ? "\n" : ",\n", _file);
+    _firstEvent = false;
+}
+
+static void Drain() {
+    uint32_t numBuffers = std::min(_numBuffers.load(std::memory_order_acquire), MAX_THREADS);
+    for (uint32_t tid = 0; tid < numBuffers; tid++) {
+        Record record;
+        while (_buffers[tid].records.TryPop(&record)) {
+            double ts = (double)(record.start - _startTicks) * _usPerTick;
+            double dur = (double)(record.end - record.start) * _usPerTick;
+            WriteSeparator();
+            fprintf(_file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    record.name, tid, ts, dur);
+        }
+    }
+}
+
+static void FlushLoop() {
+    while (_flushRunning.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(FLUSH_INTERVAL);
+        Drain();
+    }
+}
+
+bool Start(const char* path) {
+    _file = fopen(path, "w");
+    if (_file == nullptr) {
+        SDL_Log("Could not open trace file %s", path);
+        return false;
+    }
+    fputs("{\"traceEvents\":[", _file);
+    _firstEvent = true;
+    _startTicks = SDL_GetPerformanceCounter();
+    _usPerTick = 1e6 / (double)SDL_GetPerformanceFrequency();
+
+    _flushRunning = true;
+    _flushThread = std::thread(FlushLoop);
+    NameThread("main");
+    _enabled = true;
+    SDL_Log("Tracing to %s", path);
+    return true;
+}
+
+void Stop() {
+    if (_file == nullptr) {
+        return;
+    }
+    _enabled = false;
+    _flushRunning = false;
+    _flushThread.join();
+    Drain();
+
+    uint32_t numBuffers = std::min(_numBuffers.load(std::memory_order_acquire), MAX_THREADS);
+    for (uint32_t tid = 0; tid < numBuffers; tid++) {
+        const char* name = _buffers[tid].name.load(std::memory_order_relaxed);
+        if (name) {
+            WriteSeparator();
+            fprintf(_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    tid, name);
+        }
+        uint32_t dropped = _buffers[tid].dropped.load(std::memory_order_relaxed);
+        if (dropped > 0) {
+            SDL_Log("Trace buffer for thread %u overflowed, dropped %u zones", tid, dropped);
+        }
+    }
+    fputs("\n]}\n", _file);
+    fclose(_file);
+    _file = nullptr;
+}
+
+} // namespace trace
+
+#else
+
+namespace trace {
+
+bool Start(const char* path) {
+    SDL_Log("Built without tracing, rebuild with -DSYNTH_ENABLE_TRACE=ON");
+    return false;
+}
+
+void Stop() {
+}
+
+} // namespace trace
+
+#endif // SYNTH_TRACE
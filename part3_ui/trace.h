@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+// Opt-in profiling with Chrome trace-event output. Build with SYNTH_TRACE
+// defined (cmake -DSYNTH_ENABLE_TRACE=ON) and run with --trace out.json,
+// then open the file in chrome://tracing or https://ui.perfetto.dev.
+//
+// Zones record into a preallocated lock-free buffer per thread, so they
+// are safe on the audio thread. A background thread drains the buffers
+// to the file. Without SYNTH_TRACE the macros compile to nothing.
+namespace trace {
+
+// Start writing to path. Returns false if tracing isn't compiled in or
+// the file can't be opened.
+bool Start(const char* path);
+
+// Flush everything and close the file
+void Stop();
+
+#ifdef SYNTH_TRACE
+
+// Records the time between construction and destruction. name must be a
+// string literal (or otherwise outlive the trace).
+class Zone {
+public:
+    explicit Zone(const char* name);
+    ~Zone();
+
+private:
+    const char* _name;
+    uint64_t _start;
+};
+
+// Label the calling thread in the trace viewer
+void NameThread(const char* name);
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(name) trace::Zone TRACE_CONCAT(_traceZone, __LINE__)(name)
+#define TRACE_THREAD(name) trace::NameThread(name)
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_THREAD(name)
+
+#endif
+
+} // namespace trace
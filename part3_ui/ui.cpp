@@ -2,6 +2,7 @@
 #include "ui.h"
 #include "utility.h"
 #include "synth.h"
+#include "trace.h"
 #ifdef IS_WASM_BUILD
 #include <GLES2/gl2.h>
 #include <nanovg.h>
@@ -37,6 +38,13 @@ static constexpr float KNOB_LABEL_GAP = 8.f;
 static constexpr float KNOB_HEIGHT = (KNOB_WIDTH + KNOB_LABEL_GAP + LABEL_HEIGHT);
 static constexpr float WAVEFORM_HEIGHT = 2.f * KNOB_HEIGHT + PAD;
 static constexpr float WAVEFORM_WIDTH = WAVEFORM_HEIGHT;
+static constexpr float DSP_METER_WIDTH = 200.f;
+static constexpr float DSP_METER_HEIGHT = LABEL_HEIGHT;
+static constexpr float DSP_METER_WARNING = 0.8f; // load shown in red above this
+static constexpr float PATCH_SELECTOR_WIDTH = 200.f;
+static constexpr float PATCH_SELECTOR_HEIGHT = 30.f;
+static constexpr float SPECTRUM_WIDTH = 360.f;
+static constexpr float SPECTRUM_HEIGHT = WAVEFORM_HEIGHT + 2.f * PAD;
 
 static constexpr NVGcolor ALMOST_WHITE = RGBAtoColor(240, 240, 240, 255);
 static constexpr NVGcolor BG_GREY = RGBAtoColor(39,42,45,255);
@@ -49,14 +57,7 @@ static constexpr NVGcolor LIGHT_GREY = OSC_ENABLED_GREY;
 static constexpr NVGcolor DARK_GREY = RGBAtoColor(25, 25, 25, 255);
 static constexpr NVGcolor WHITE = RGBAtoColor(255, 255, 255, 255);
 static constexpr NVGcolor TRANSPARENT = RGBAtoColor(0, 0, 0, 0);
-
-static constexpr std::array<std::pair<SDL_Keycode, uint8_t>, 13> NOTES_MAP = {{
-    // C3 to C4
-    { SDLK_a, 39 }, { SDLK_w, 40 }, { SDLK_s, 41 }, { SDLK_e, 42 },
-    { SDLK_d, 43 }, { SDLK_f, 44 }, { SDLK_t, 45 }, { SDLK_g, 46 },
-    { SDLK_y, 47 }, { SDLK_h, 48 }, { SDLK_u, 49 }, { SDLK_j, 50 },
-    { SDLK_k, 51 },
-}};
+static constexpr NVGcolor WARNING_RED = RGBAtoColor(235, 87, 87, 255);
 
 void ClearBackground(NVGcolor color) {
     glClearColor(color.r, color.g, color.b, color.a);
@@ -108,7 +109,11 @@ bool UI::Init(Synth* synth) {
     nvgFontFaceId(_nvg, _fontId);
     _idStack.push_back(std::hash<const char*>{}("root"));
 
+    if (!_spectrum.Init(_synth->sampleRateHz)) {
+        return false;
+    }
     UpdateOscillatorVisualization();
+    UpdateKnobLevels();
 
     return true;
 }
@@ -359,16 +364,100 @@ bool UI::ArrowButton(float x, float y, float radius, bool isLeft) {
 void UI::UpdateOscillatorVisualization() {
     for (uint32_t i = 0; i < _oscPoints.size(); i++) {
         float phase = i * TWOPI/_oscPoints.size();
-        _oscPoints[i] = _synth->osc.Fn(phase);
+        _oscPoints[i] = ::Oscillator::SourceFn(_oscParams.bank[0].sourceIndex, phase);
+    }
+}
+
+void UI::SendEvent(const Event& event) {
+    if (!_synth->events.TryPush(event)) {
+        SDL_Log("Event queue full, dropped UI event");
+    }
+}
+
+void UI::SendParam(Event::Param param, float oldValue, float newValue, uint8_t oscillator) {
+    if (newValue != oldValue) {
+        SendEvent(Event::ParamChange(SDL_GetTicks(), param, newValue, oscillator));
+    }
+}
+
+void UI::SendEffect(Event::Effect effect, float oldValue, float newValue) {
+    if (newValue != oldValue) {
+        SendEvent(Event::EffectChange(SDL_GetTicks(), effect, newValue));
+    }
+}
+
+// Steps of a knob that picks one of count choices
+static uint32_t KnobStep(float level, uint32_t count) {
+    return (uint32_t)round(level * (float)(count - 1));
+}
+
+// The inverse, the level that shows step
+static float KnobLevel(uint32_t step, uint32_t count) {
+    return (float)step / (float)(count - 1);
+}
+
+void UI::UpdateKnobLevels() {
+    _filterKnobLevel = KnobLevel(_oscParams.filterType, filter::NUM_TYPES);
+    _unisonKnobLevel = KnobLevel(_oscParams.unison - 1, MAX_UNISON);
+    for (uint32_t o = 0; o < NUM_OSCILLATORS; o++) {
+        _waveKnobLevels[o] = KnobLevel(_oscParams.bank[o].sourceIndex, ::Oscillator::NumSources());
+    }
+    for (uint32_t l = 0; l < mod::NUM_LFOS; l++) {
+        _lfoShapeKnobLevels[l] = KnobLevel((uint32_t)_modSettings.lfos[l].shape, mod::NUM_LFO_SHAPES);
+    }
+    for (uint32_t r = 0; r < mod::Settings::MAX_ROUTES; r++) {
+        _routeSourceKnobLevels[r] = KnobLevel((uint32_t)_modSettings.routes[r].source, mod::NUM_SOURCES);
+        _routeDestKnobLevels[r] = KnobLevel((uint32_t)_modSettings.routes[r].dest, mod::NUM_DESTS);
+    }
+    _delaySyncKnobLevel = KnobLevel((uint32_t)_delayParams.sync, NUM_DELAY_SYNCS);
+}
+
+void UI::PatchSelector(float x, float y) {
+    Label("PATCH", x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x, y, PATCH_SELECTOR_WIDTH, PATCH_SELECTOR_HEIGHT, 5.f);
+    nvgFillColor(_nvg, DARK_GREY);
+    nvgFill(_nvg);
+
+    float buttonRadius = 10.f;
+    float buttonCenterY = y + PATCH_SELECTOR_HEIGHT/2.f;
+    uint32_t numPatches = NumFactoryPatches();
+    uint32_t patchIndex = _patchIndex;
+    if (ArrowButton(x + PAD/3.f + buttonRadius, buttonCenterY, buttonRadius, true)) {
+        patchIndex = (_patchIndex == 0 ? numPatches - 1 : _patchIndex - 1);
+    }
+    if (ArrowButton(x + PATCH_SELECTOR_WIDTH - PAD/3.f - buttonRadius, buttonCenterY, buttonRadius, false)) {
+        patchIndex = (_patchIndex + 1) % numPatches;
     }
+    if (patchIndex != _patchIndex) {
+        LoadPatch(patchIndex);
+    }
+    Label(FactoryPatch(_patchIndex).name, x + PATCH_SELECTOR_WIDTH/2.f, buttonCenterY, 14, ALMOST_WHITE);
+}
+
+// Every knob jumps to the patch. The audio thread gets it in one piece,
+// then the knobs' copies match it, so none of them send events.
+void UI::LoadPatch(uint32_t index) {
+    const Patch& patch = FactoryPatch(index);
+    _synth->patches.Publish(patch, &_synth->mod);
+    SendEvent(Event::PatchChange(SDL_GetTicks(), index));
+    _patchIndex = index;
+    _oscParams = patch.osc;
+    _modSettings = patch.mod;
+    _delayParams = patch.delay;
+    _reverbParams = patch.reverb;
+    UpdateKnobLevels();
+    UpdateOscillatorVisualization();
 }
 
 void UI::Oscillator(const char* name, float x, float y) {
     size_t id = ScopedId(_idStack, name).value();
 
-    float num_knobs = 4.f;
+    float num_knobs = 5.f;
+    float num_knob_rows = 3.f;
     float rw = PAD + (WAVEFORM_WIDTH + PAD) + num_knobs * (KNOB_WIDTH + PAD);
-    float rh = 2.f * PAD + WAVEFORM_HEIGHT;
+    float rh = PAD + num_knob_rows * (KNOB_HEIGHT + PAD);
 
     Label(name, x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
 
@@ -406,28 +495,48 @@ void UI::Oscillator(const char* name, float x, float y) {
         float rightButtonCenterX = xoff + WAVEFORM_WIDTH - PAD/3.f - buttonRadius;
         float buttonCenterY = yoff + buttonOffset;
         if (ArrowButton(leftButtonCenterX, buttonCenterY, buttonRadius, true)) {
-            _synth->osc.Prev();
+            _oscParams.bank[0].sourceIndex = ::Oscillator::PrevSource(_oscParams.bank[0].sourceIndex);
+            SendEvent(Event::OscillatorSelect(SDL_GetTicks(), _oscParams.bank[0].sourceIndex));
             UpdateOscillatorVisualization();
         }
         if (ArrowButton(rightButtonCenterX, buttonCenterY, buttonRadius, false)) {
-            _synth->osc.Next();
+            _oscParams.bank[0].sourceIndex = ::Oscillator::NextSource(_oscParams.bank[0].sourceIndex);
+            SendEvent(Event::OscillatorSelect(SDL_GetTicks(), _oscParams.bank[0].sourceIndex));
             UpdateOscillatorVisualization();
         }
 
         // Oscillator name
-        Label(_synth->osc.GetName(), xoff + WAVEFORM_WIDTH/2.f, buttonCenterY, 14, ALMOST_WHITE);
+        Label(::Oscillator::SourceName(_oscParams.bank[0].sourceIndex), xoff + WAVEFORM_WIDTH/2.f, buttonCenterY, 14, ALMOST_WHITE);
 
-        // Waveform visualization
+        // Waveform visualization. Live output when there is any, otherwise
+        // one cycle of the selected source.
         {
             nvgSave(_nvg);
             nvgTranslate(_nvg, xoff, yoff + WAVEFORM_HEIGHT/2.f + PAD);
             nvgScale(_nvg, WAVEFORM_WIDTH, 0.7f * WAVEFORM_HEIGHT / 2.f);
             nvgBeginPath(_nvg);
-            nvgMoveTo(_nvg, 0, _oscPoints[0]);
-            for (uint32_t i = 1; i < _oscPoints.size(); i++) {
-                nvgLineTo(_nvg, i * 1.f / _oscPoints.size(), _oscPoints[i]);
+            if (_scope.Trace(_scopeMins.data(), _scopeMaxs.data(), SCOPE_COLUMNS)) {
+                // Outline of the min/max envelope: along the maxima, then
+                // back along the minima
+                float dx = 1.f / (SCOPE_COLUMNS - 1);
+                nvgMoveTo(_nvg, 0, -utility::Clamp(_scopeMaxs[0], -1.f, 1.f));
+                for (size_t i = 1; i < SCOPE_COLUMNS; i++) {
+                    nvgLineTo(_nvg, (float)i * dx, -utility::Clamp(_scopeMaxs[i], -1.f, 1.f));
+                }
+                for (size_t i = SCOPE_COLUMNS; i-- > 0;) {
+                    nvgLineTo(_nvg, (float)i * dx, -utility::Clamp(_scopeMins[i], -1.f, 1.f));
+                }
+                nvgClosePath(_nvg);
+                nvgRestore(_nvg);
+                nvgFillColor(_nvg, KNOB_ACTIVE_PURPLE);
+                nvgFill(_nvg);
+            } else {
+                nvgMoveTo(_nvg, 0, -_oscPoints[0]);
+                for (uint32_t i = 1; i < _oscPoints.size(); i++) {
+                    nvgLineTo(_nvg, i * 1.f / _oscPoints.size(), -_oscPoints[i]);
+                }
+                nvgRestore(_nvg);
             }
-            nvgRestore(_nvg);
             nvgStrokeWidth(_nvg, 2.f);
             nvgStrokeColor(_nvg, KNOB_ACTIVE_PURPLE);
             nvgStroke(_nvg);
@@ -440,57 +549,553 @@ void UI::Oscillator(const char* name, float x, float y) {
     //-----------------------
     // Knobs
     //-----------------------
-    float levelValue = _synth->osc.volume;
+    float knobsX = xoff;
+    float levelValue = _oscParams.volume;
     char levelText[16] = {};
     snprintf(levelText, sizeof(levelText), "%3.1f%%", fabs(levelValue * 100.f));
     Knob("LEVEL", xoff, yoff, 0.f, 0.7f, &levelValue, levelText);
-    _synth->osc.volume = levelValue;
+    SendParam(Event::Param::Volume, _oscParams.volume, levelValue);
+    _oscParams.volume = levelValue;
 
     xoff += (KNOB_WIDTH + PAD);
 
-    float panValue = _synth->osc.pan;
+    float panValue = _oscParams.pan;
     int left = (int)(round(100.f * utility::Map(panValue, -.5f, .5f, 1.0f, 0.0f)));
     int right = 100 - left;
     char panText[16] = {};
     snprintf(panText, sizeof(panText), "%dL/%dR", left, right);
     Knob("PAN", xoff, yoff, 0.5f, 0.0f, &panValue, panText);
-    _synth->osc.pan = panValue;
+    SendParam(Event::Param::Pan, _oscParams.pan, panValue);
+    _oscParams.pan = panValue;
 
     xoff += (KNOB_WIDTH + PAD);
 
-    float coarseValue = _synth->osc.coarsePitch;
+    float coarseValue = _oscParams.coarsePitch;
     float coarseKnobLevel = utility::Map(coarseValue, -36.f, 36.f, -.5, .5);
     char coarseText[16] = {};
     snprintf(coarseText, sizeof(coarseText), "%d st", (int32_t)round(coarseValue));
     Knob("PITCH", xoff, yoff, 0.5f, 0.0f, &coarseKnobLevel, coarseText);
     coarseValue = utility::Map(coarseKnobLevel, -.5f, .5f, -36.f, 36.f);
-    _synth->osc.coarsePitch = coarseValue;
+    SendParam(Event::Param::CoarsePitch, _oscParams.coarsePitch, coarseValue);
+    _oscParams.coarsePitch = coarseValue;
 
     xoff += (KNOB_WIDTH + PAD);
 
-    float fineValue = _synth->osc.finePitch;
+    float fineValue = _oscParams.finePitch;
     float fineKnobLevel = utility::Map(fineValue, -100.f, 100.f, -.5f, .5f);
     char fineText[16] = {};
     snprintf(fineText, sizeof(fineText), "%3.1f cents", fineValue);
     Knob("FINE", xoff, yoff, 0.5f, 0.0f, &fineKnobLevel, fineText);
     fineValue = utility::Map(fineKnobLevel, -.5f, .5f, -100.f, 100.f);
-    _synth->osc.finePitch = fineValue;
+    SendParam(Event::Param::FinePitch, _oscParams.finePitch, fineValue);
+    _oscParams.finePitch = fineValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    uint32_t unison = KnobStep(_unisonKnobLevel, MAX_UNISON) + 1;
+    char unisonText[16] = {};
+    snprintf(unisonText, sizeof(unisonText), "%u", unison);
+    Knob("UNISON", xoff, yoff, 0.f, 0.f, &_unisonKnobLevel, unisonText);
+    unison = KnobStep(_unisonKnobLevel, MAX_UNISON) + 1;
+    SendParam(Event::Param::Unison, (float)_oscParams.unison, (float)unison);
+    _oscParams.unison = unison;
+
+    // Second row
+    xoff = knobsX;
+    yoff += (KNOB_HEIGHT + PAD);
+
+    float driveValue = _oscParams.drive;
+    char driveText[16] = {};
+    snprintf(driveText, sizeof(driveText), "%3.1f%%", driveValue * 100.f);
+    Knob("DRIVE", xoff, yoff, 0.f, 0.f, &driveValue, driveText);
+    SendParam(Event::Param::Drive, _oscParams.drive, driveValue);
+    _oscParams.drive = driveValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    uint32_t filterType = KnobStep(_filterKnobLevel, filter::NUM_TYPES);
+    Knob("FILTER", xoff, yoff, 0.f, 0.f, &_filterKnobLevel, filter::TypeName((filter::Type)filterType));
+    filterType = KnobStep(_filterKnobLevel, filter::NUM_TYPES);
+    SendParam(Event::Param::FilterType, (float)_oscParams.filterType, (float)filterType);
+    _oscParams.filterType = filterType;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    // 20 Hz to 20 kHz, even in octaves
+    float cutoffValue = _oscParams.cutoffHz;
+    float cutoffKnobLevel = log2f(cutoffValue / filter::MIN_CUTOFF_HZ) / log2f(filter::MAX_CUTOFF_HZ / filter::MIN_CUTOFF_HZ);
+    char cutoffText[16] = {};
+    if (cutoffValue < 1000.f) {
+        snprintf(cutoffText, sizeof(cutoffText), "%d Hz", (int)round(cutoffValue));
+    } else {
+        snprintf(cutoffText, sizeof(cutoffText), "%3.1f kHz", cutoffValue / 1000.f);
+    }
+    Knob("CUTOFF", xoff, yoff, 0.f, 1.f, &cutoffKnobLevel, cutoffText);
+    cutoffValue = filter::MIN_CUTOFF_HZ * powf(filter::MAX_CUTOFF_HZ / filter::MIN_CUTOFF_HZ, cutoffKnobLevel);
+    SendParam(Event::Param::FilterCutoff, _oscParams.cutoffHz, cutoffValue);
+    _oscParams.cutoffHz = cutoffValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float resonanceValue = _oscParams.resonance;
+    char resonanceText[16] = {};
+    snprintf(resonanceText, sizeof(resonanceText), "%3.1f%%", resonanceValue * 100.f);
+    Knob("RES", xoff, yoff, 0.f, 0.f, &resonanceValue, resonanceText);
+    SendParam(Event::Param::FilterResonance, _oscParams.resonance, resonanceValue);
+    _oscParams.resonance = resonanceValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float detuneValue = _oscParams.detune;
+    char detuneText[16] = {};
+    snprintf(detuneText, sizeof(detuneText), "%3.1f%%", detuneValue * 100.f);
+    Knob("DETUNE", xoff, yoff, 0.f, OscillatorParams().detune, &detuneValue, detuneText);
+    SendParam(Event::Param::Detune, _oscParams.detune, detuneValue);
+    _oscParams.detune = detuneValue;
+
+    // Third row, amplitude envelope
+    xoff = knobsX;
+    yoff += (KNOB_HEIGHT + PAD);
+
+    EnvelopeParams& env = _oscParams.envelope;
+    EnvelopeTimeKnob("ATTACK", xoff, yoff, EnvelopeParams().attackMs, Event::Param::Attack, &env.attackMs);
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    EnvelopeTimeKnob("DECAY", xoff, yoff, EnvelopeParams().decayMs, Event::Param::Decay, &env.decayMs);
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float sustainValue = env.sustain;
+    char sustainText[16] = {};
+    snprintf(sustainText, sizeof(sustainText), "%3.1f%%", sustainValue * 100.f);
+    Knob("SUSTAIN", xoff, yoff, 0.f, EnvelopeParams().sustain, &sustainValue, sustainText);
+    SendParam(Event::Param::Sustain, env.sustain, sustainValue);
+    env.sustain = sustainValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    EnvelopeTimeKnob("RELEASE", xoff, yoff, EnvelopeParams().releaseMs, Event::Param::Release, &env.releaseMs);
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float spreadValue = _oscParams.spread;
+    char spreadText[16] = {};
+    snprintf(spreadText, sizeof(spreadText), "%3.1f%%", spreadValue * 100.f);
+    Knob("SPREAD", xoff, yoff, 0.f, OscillatorParams().spread, &spreadValue, spreadText);
+    SendParam(Event::Param::Spread, _oscParams.spread, spreadValue);
+    _oscParams.spread = spreadValue;
 }
 
-void UI::Draw() {
-    ClearBackground(BG_GREY);
+// OSC B and C: waveform, level, and pitch on top of OSC A's. They share
+// OSC A's filter, envelope and unison.
+void UI::BankOscillator(const char* name, float x, float y, uint8_t oscillator) {
+    // Knob labels repeat between the panels, and FINE is also on OSC A
+    ScopedId panelId(_idStack, name);
+
+    float numColumns = 4.f;
+    float rw = PAD + numColumns * (KNOB_WIDTH + PAD);
+    float rh = PAD + (KNOB_HEIGHT + PAD);
+
+    Label(name, x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x, y, rw, rh, 5.f);
+    nvgFillColor(_nvg, OSC_ENABLED_GREY);
+    nvgStrokeWidth(_nvg, 2.f);
+    nvgStrokeColor(_nvg, DARK_GREY);
+    nvgFill(_nvg);
+    nvgStroke(_nvg);
+
+    BankOscillatorParams& bank = _oscParams.bank[oscillator];
+    const BankOscillatorParams defaults = OscillatorParams().bank[oscillator];
+    float xoff = x + PAD;
+    float yoff = y + PAD;
+    char valueText[16] = {};
+
+    float& waveKnobLevel = _waveKnobLevels[oscillator];
+    uint32_t source = KnobStep(waveKnobLevel, ::Oscillator::NumSources());
+    float defaultWaveLevel = (float)defaults.sourceIndex / (float)(::Oscillator::NumSources() - 1);
+    Knob("WAVE", xoff, yoff, 0.f, defaultWaveLevel, &waveKnobLevel, ::Oscillator::SourceName(source));
+    source = KnobStep(waveKnobLevel, ::Oscillator::NumSources());
+    if (source != bank.sourceIndex) {
+        SendEvent(Event::OscillatorSelect(SDL_GetTicks(), source, oscillator));
+        bank.sourceIndex = source;
+    }
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float mixValue = bank.mix;
+    snprintf(valueText, sizeof(valueText), "%3.1f%%", mixValue * 100.f);
+    Knob("MIX", xoff, yoff, 0.f, defaults.mix, &mixValue, valueText);
+    SendParam(Event::Param::OscMix, bank.mix, mixValue, oscillator);
+    bank.mix = mixValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float coarseKnobLevel = utility::Map(bank.coarse, -24.f, 24.f, -.5f, .5f);
+    float defaultCoarseLevel = utility::Map(defaults.coarse, -24.f, 24.f, -.5f, .5f);
+    snprintf(valueText, sizeof(valueText), "%d st", (int32_t)round(bank.coarse));
+    Knob("SEMI", xoff, yoff, 0.5f, defaultCoarseLevel, &coarseKnobLevel, valueText);
+    float coarseValue = utility::Map(coarseKnobLevel, -.5f, .5f, -24.f, 24.f);
+    SendParam(Event::Param::OscCoarse, bank.coarse, coarseValue, oscillator);
+    bank.coarse = coarseValue;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float fineKnobLevel = utility::Map(bank.fine, -100.f, 100.f, -.5f, .5f);
+    snprintf(valueText, sizeof(valueText), "%3.1f cents", bank.fine);
+    Knob("FINE", xoff, yoff, 0.5f, 0.0f, &fineKnobLevel, valueText);
+    float fineValue = utility::Map(fineKnobLevel, -.5f, .5f, -100.f, 100.f);
+    SendParam(Event::Param::OscFine, bank.fine, fineValue, oscillator);
+    bank.fine = fineValue;
+}
+
+// 1 ms to 10 s, even in log time
+void UI::EnvelopeTimeKnob(const char* text, float x, float y, float defaultMs, Event::Param param, float* ms) {
+    float range = log2f(Envelope::MAX_TIME_MS / Envelope::MIN_TIME_MS);
+    float knobLevel = log2f(*ms / Envelope::MIN_TIME_MS) / range;
+    float defaultLevel = log2f(defaultMs / Envelope::MIN_TIME_MS) / range;
+    char valueText[16] = {};
+    if (*ms < 1000.f) {
+        snprintf(valueText, sizeof(valueText), "%d ms", (int)round(*ms));
+    } else {
+        snprintf(valueText, sizeof(valueText), "%3.2f s", *ms / 1000.f);
+    }
+    Knob(text, x, y, 0.f, defaultLevel, &knobLevel, valueText);
+    float value = Envelope::MIN_TIME_MS * exp2f(knobLevel * range);
+    SendParam(param, *ms, value);
+    *ms = value;
+}
+
+static bool SameModSettings(const mod::Settings& a, const mod::Settings& b) {
+    for (size_t l = 0; l < mod::NUM_LFOS; l++) {
+        if (a.lfos[l].shape != b.lfos[l].shape || a.lfos[l].rateHz != b.lfos[l].rateHz) {
+            return false;
+        }
+    }
+    for (size_t r = 0; r < mod::Settings::MAX_ROUTES; r++) {
+        const mod::Route& ra = a.routes[r];
+        const mod::Route& rb = b.routes[r];
+        if (ra.source != rb.source || ra.dest != rb.dest || ra.amount != rb.amount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void UI::ModPanel(const char* name, float x, float y) {
+    float numColumns = (float)(mod::NUM_LFOS + mod::Settings::MAX_ROUTES);
+    float numRows = 3.f;
+    float rw = PAD + numColumns * (KNOB_WIDTH + PAD);
+    float rh = PAD + numRows * (KNOB_HEIGHT + PAD);
+
+    Label(name, x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x, y, rw, rh, 5.f);
+    nvgFillColor(_nvg, OSC_ENABLED_GREY);
+    nvgStrokeWidth(_nvg, 2.f);
+    nvgStrokeColor(_nvg, DARK_GREY);
+    nvgFill(_nvg);
+    nvgStroke(_nvg);
+
+    mod::Settings old = _modSettings;
+    float xoff = x + PAD;
+    char label[16] = {};
+    char valueText[16] = {};
+
+    //-----------------------
+    // LFOs, one column each
+    //-----------------------
+    for (size_t l = 0; l < mod::NUM_LFOS; l++) {
+        mod::Lfo& lfo = _modSettings.lfos[l];
+        float yoff = y + PAD;
+
+        // 0.05 to 20 Hz, even in octaves
+        float range = log2f(mod::MAX_LFO_RATE_HZ / mod::MIN_LFO_RATE_HZ);
+        float rateKnobLevel = log2f(lfo.rateHz / mod::MIN_LFO_RATE_HZ) / range;
+        float defaultLevel = log2f(mod::Lfo().rateHz / mod::MIN_LFO_RATE_HZ) / range;
+        snprintf(label, sizeof(label), "RATE %zu", l + 1);
+        snprintf(valueText, sizeof(valueText), "%3.2f Hz", lfo.rateHz);
+        Knob(label, xoff, yoff, 0.f, defaultLevel, &rateKnobLevel, valueText);
+        lfo.rateHz = mod::MIN_LFO_RATE_HZ * exp2f(rateKnobLevel * range);
+
+        yoff += (KNOB_HEIGHT + PAD);
+
+        snprintf(label, sizeof(label), "LFO %zu", l + 1);
+        Knob(label, xoff, yoff, 0.f, 0.f, &_lfoShapeKnobLevels[l], mod::LfoShapeName(lfo.shape));
+        lfo.shape = (mod::LfoShape)KnobStep(_lfoShapeKnobLevels[l], mod::NUM_LFO_SHAPES);
+
+        xoff += (KNOB_WIDTH + PAD);
+    }
+
+    //-----------------------
+    // Routes, one column each
+    //-----------------------
+    for (size_t r = 0; r < mod::Settings::MAX_ROUTES; r++) {
+        mod::Route& route = _modSettings.routes[r];
+        float yoff = y + PAD;
+
+        snprintf(label, sizeof(label), "SRC %zu", r + 1);
+        Knob(label, xoff, yoff, 0.f, 0.f, &_routeSourceKnobLevels[r], mod::SourceName(route.source));
+        route.source = (mod::Source)KnobStep(_routeSourceKnobLevels[r], mod::NUM_SOURCES);
+
+        yoff += (KNOB_HEIGHT + PAD);
+
+        snprintf(label, sizeof(label), "DEST %zu", r + 1);
+        Knob(label, xoff, yoff, 0.f, 0.f, &_routeDestKnobLevels[r], mod::DestName(route.dest));
+        route.dest = (mod::Dest)KnobStep(_routeDestKnobLevels[r], mod::NUM_DESTS);
+
+        yoff += (KNOB_HEIGHT + PAD);
+
+        // Bipolar, centered on off
+        float amountKnobLevel = route.amount / 2.f;
+        snprintf(label, sizeof(label), "AMT %zu", r + 1);
+        snprintf(valueText, sizeof(valueText), "%+d%%", (int)round(route.amount * 100.f));
+        Knob(label, xoff, yoff, 0.5f, 0.f, &amountKnobLevel, valueText);
+        route.amount = 2.f * amountKnobLevel;
+
+        xoff += (KNOB_WIDTH + PAD);
+    }
+
+    // Rebuilt here on the UI thread, the audio thread only swaps it in
+    if (!SameModSettings(old, _modSettings)) {
+        _synth->mod.Publish(_modSettings);
+    }
+}
+
+void UI::EffectsPanel(const char* name, float x, float y) {
+    // Knob labels repeat (MIX), and DECAY is also on the oscillator
+    ScopedId panelId(_idStack, name);
+
+    float numColumns = 5.f;
+    float numRows = 2.f;
+    float rw = PAD + numColumns * (KNOB_WIDTH + PAD);
+    float rh = PAD + numRows * (KNOB_HEIGHT + PAD);
+
+    Label(name, x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x, y, rw, rh, 5.f);
+    nvgFillColor(_nvg, OSC_ENABLED_GREY);
+    nvgStrokeWidth(_nvg, 2.f);
+    nvgStrokeColor(_nvg, DARK_GREY);
+    nvgFill(_nvg);
+    nvgStroke(_nvg);
+
+    float xoff = x + PAD;
+    float yoff = y + PAD;
+    char valueText[16] = {};
+
+    //-----------------------
+    // Delay
+    //-----------------------
+    DelayParams& delay = _delayParams;
+    float delayKnobLevel = (delay.enabled ? 1.f : 0.f);
+    Knob("DELAY", xoff, yoff, 0.f, 0.f, &delayKnobLevel, delay.enabled ? "On" : "Off");
+    bool delayEnabled = (KnobStep(delayKnobLevel, 2) == 1);
+    SendEffect(Event::Effect::DelayEnabled, delay.enabled ? 1.f : 0.f, delayEnabled ? 1.f : 0.f);
+    delay.enabled = delayEnabled;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    Knob("SYNC", xoff, yoff, 0.f, 0.f, &_delaySyncKnobLevel, DelaySyncName(delay.sync));
+    uint32_t sync = KnobStep(_delaySyncKnobLevel, NUM_DELAY_SYNCS);
+    SendEffect(Event::Effect::DelaySync, (float)delay.sync, (float)sync);
+    delay.sync = (DelaySync)sync;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    // Free time, even in log time. Shows the synced time when synced.
+    float timeRange = log2f(StereoDelay::MAX_TIME_MS / StereoDelay::MIN_TIME_MS);
+    float timeKnobLevel = log2f(delay.timeMs / StereoDelay::MIN_TIME_MS) / timeRange;
+    float timeDefaultLevel = log2f(DelayParams().timeMs / StereoDelay::MIN_TIME_MS) / timeRange;
+    snprintf(valueText, sizeof(valueText), "%d ms", (int)round(StereoDelay::TimeMs(delay)));
+    Knob("TIME", xoff, yoff, 0.f, timeDefaultLevel, &timeKnobLevel, valueText);
+    float timeMs = StereoDelay::MIN_TIME_MS * exp2f(timeKnobLevel * timeRange);
+    SendEffect(Event::Effect::DelayTime, delay.timeMs, timeMs);
+    delay.timeMs = timeMs;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float feedbackKnobLevel = delay.feedback / StereoDelay::MAX_FEEDBACK;
+    snprintf(valueText, sizeof(valueText), "%3.1f%%", delay.feedback * 100.f);
+    Knob("FDBK", xoff, yoff, 0.f, DelayParams().feedback / StereoDelay::MAX_FEEDBACK, &feedbackKnobLevel, valueText);
+    float feedback = feedbackKnobLevel * StereoDelay::MAX_FEEDBACK;
+    SendEffect(Event::Effect::DelayFeedback, delay.feedback, feedback);
+    delay.feedback = feedback;
+
+    xoff += (KNOB_WIDTH + PAD);
 
-    // Set oscillator note based on key presses
-    // TODO - is there a better place for this?
-    _synth->osc.noteActive = false;
-    for (const auto& note : NOTES_MAP) {
-        if (_input->IsKeyPressed(note.first)) {
-            _synth->osc.noteActive = true;
-            _synth->osc.noteIndex = note.second;
+    float delayMix = delay.mix;
+    snprintf(valueText, sizeof(valueText), "%3.1f%%", delayMix * 100.f);
+    Knob("MIX", xoff, yoff, 0.f, DelayParams().mix, &delayMix, valueText);
+    SendEffect(Event::Effect::DelayMix, delay.mix, delayMix);
+    delay.mix = delayMix;
+
+    //-----------------------
+    // Reverb
+    //-----------------------
+    xoff = x + PAD;
+    yoff += (KNOB_HEIGHT + PAD);
+
+    ScopedId reverbId(_idStack, 1);
+    ReverbParams& reverb = _reverbParams;
+    float reverbKnobLevel = (reverb.enabled ? 1.f : 0.f);
+    Knob("REVERB", xoff, yoff, 0.f, 0.f, &reverbKnobLevel, reverb.enabled ? "On" : "Off");
+    bool reverbEnabled = (KnobStep(reverbKnobLevel, 2) == 1);
+    SendEffect(Event::Effect::ReverbEnabled, reverb.enabled ? 1.f : 0.f, reverbEnabled ? 1.f : 0.f);
+    reverb.enabled = reverbEnabled;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float decayRange = log2f(Reverb::MAX_DECAY_SEC / Reverb::MIN_DECAY_SEC);
+    float decayKnobLevel = log2f(reverb.decaySec / Reverb::MIN_DECAY_SEC) / decayRange;
+    float decayDefaultLevel = log2f(ReverbParams().decaySec / Reverb::MIN_DECAY_SEC) / decayRange;
+    snprintf(valueText, sizeof(valueText), "%3.1f s", reverb.decaySec);
+    Knob("DECAY", xoff, yoff, 0.f, decayDefaultLevel, &decayKnobLevel, valueText);
+    float decaySec = Reverb::MIN_DECAY_SEC * exp2f(decayKnobLevel * decayRange);
+    SendEffect(Event::Effect::ReverbDecay, reverb.decaySec, decaySec);
+    reverb.decaySec = decaySec;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float damping = reverb.damping;
+    snprintf(valueText, sizeof(valueText), "%3.1f%%", damping * 100.f);
+    Knob("DAMP", xoff, yoff, 0.f, ReverbParams().damping, &damping, valueText);
+    SendEffect(Event::Effect::ReverbDamping, reverb.damping, damping);
+    reverb.damping = damping;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    float reverbMix = reverb.mix;
+    snprintf(valueText, sizeof(valueText), "%3.1f%%", reverbMix * 100.f);
+    Knob("MIX", xoff, yoff, 0.f, ReverbParams().mix, &reverbMix, valueText);
+    SendEffect(Event::Effect::ReverbMix, reverb.mix, reverbMix);
+    reverb.mix = reverbMix;
+
+    xoff += (KNOB_WIDTH + PAD);
+
+    // For the synced delay times
+    float tempoKnobLevel = utility::Map(delay.tempoBpm, StereoDelay::MIN_TEMPO_BPM, StereoDelay::MAX_TEMPO_BPM, 0.f, 1.f);
+    float tempoDefaultLevel = utility::Map(DelayParams().tempoBpm, StereoDelay::MIN_TEMPO_BPM, StereoDelay::MAX_TEMPO_BPM, 0.f, 1.f);
+    snprintf(valueText, sizeof(valueText), "%d bpm", (int)round(delay.tempoBpm));
+    Knob("TEMPO", xoff, yoff, 0.f, tempoDefaultLevel, &tempoKnobLevel, valueText);
+    float tempoBpm = roundf(utility::Map(tempoKnobLevel, 0.f, 1.f, StereoDelay::MIN_TEMPO_BPM, StereoDelay::MAX_TEMPO_BPM));
+    SendEffect(Event::Effect::Tempo, delay.tempoBpm, tempoBpm);
+    delay.tempoBpm = tempoBpm;
+}
+
+void UI::DspMeter(float x, float y) {
+    DspLoad& dsp = _synth->dspLoad;
+    float load = dsp.Load();
+    float peak = dsp.PeakLoad();
+
+    Label("DSP", x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+
+    // Background
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x, y, DSP_METER_WIDTH, DSP_METER_HEIGHT, 5.f);
+    nvgFillColor(_nvg, DARK_GREY);
+    nvgFill(_nvg);
+
+    // Load bar, full width is 100% of the buffer deadline
+    float inset = 3.f;
+    float barMaxWidth = DSP_METER_WIDTH - 2.f * inset;
+    float barHeight = DSP_METER_HEIGHT - 2.f * inset;
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x + inset, y + inset, barMaxWidth * utility::Clamp(load, 0.f, 1.f), barHeight, 3.f);
+    nvgFillColor(_nvg, (load > DSP_METER_WARNING ? WARNING_RED : KNOB_ACTIVE_PURPLE));
+    nvgFill(_nvg);
+
+    // Peak marker
+    float peakX = x + inset + barMaxWidth * utility::Clamp(peak, 0.f, 1.f);
+    DrawLine(peakX, y + inset, peakX, y + inset + barHeight, 2.f,
+            (peak > DSP_METER_WARNING ? WARNING_RED : ALMOST_WHITE));
+
+    char text[64] = {};
+    snprintf(text, sizeof(text), "%4.1f%%   peak %4.1f%%   xruns %u", 100.f * load, 100.f * peak, dsp.Xruns());
+    Label(text, x, y + DSP_METER_HEIGHT + PAD, 12, ALMOST_WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
+
+    // Double-click the meter to reset the peak
+    if (MouseInRect(x, y, x + DSP_METER_WIDTH, y + DSP_METER_HEIGHT) && _input->mouseDoubleClick) {
+        dsp.ResetPeak();
+    }
+}
+
+void UI::SpectrumAnalyzer(float x, float y) {
+    Label("SPECTRUM", x, y - 3, 14, WHITE, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+
+    nvgBeginPath(_nvg);
+    nvgRoundedRect(_nvg, x, y, SPECTRUM_WIDTH, SPECTRUM_HEIGHT, 5.f);
+    nvgFillColor(_nvg, DARK_GREY);
+    nvgFill(_nvg);
+
+    float left = x + PAD;
+    float bottom = y + SPECTRUM_HEIGHT - PAD;
+    float width = SPECTRUM_WIDTH - 2.f * PAD;
+    float height = SPECTRUM_HEIGHT - 2.f * PAD;
+    float bandWidth = width / Spectrum::NUM_BANDS;
+    auto levelY = [&](float db) {
+        return bottom - height * utility::Map(db, Spectrum::MIN_DB, Spectrum::MAX_DB, 0.f, 1.f);
+    };
+
+    // Decade markers, bands are evenly spaced in log frequency
+    for (float hz : { 100.f, 1000.f, 10000.f }) {
+        float fx = left + width * log10f(hz / Spectrum::MIN_HZ) / log10f(Spectrum::MAX_HZ / Spectrum::MIN_HZ);
+        DrawLine(fx, y + PAD, fx, bottom, 1.f, OSC_ENABLED_GREY);
+        Label(hz < 1000.f ? "100" : (hz < 10000.f ? "1k" : "10k"), fx + 2.f, bottom, 10, LIGHT_GREY, NVG_ALIGN_LEFT | NVG_ALIGN_BOTTOM);
+    }
+
+    // Levels as one stepped outline, filled
+    nvgBeginPath(_nvg);
+    nvgMoveTo(_nvg, left, bottom);
+    for (size_t b = 0; b < Spectrum::NUM_BANDS; b++) {
+        float by = levelY(_spectrum.Level(b));
+        nvgLineTo(_nvg, left + (float)b * bandWidth, by);
+        nvgLineTo(_nvg, left + (float)(b + 1) * bandWidth, by);
+    }
+    nvgLineTo(_nvg, left + width, bottom);
+    nvgClosePath(_nvg);
+    nvgFillColor(_nvg, KNOB_ACTIVE_PURPLE);
+    nvgFill(_nvg);
+
+    // Peak hold markers, one path
+    nvgBeginPath(_nvg);
+    for (size_t b = 0; b < Spectrum::NUM_BANDS; b++) {
+        if (_spectrum.Peak(b) <= Spectrum::MIN_DB) {
+            continue;
         }
+        float py = levelY(_spectrum.Peak(b));
+        nvgMoveTo(_nvg, left + (float)b * bandWidth + 1.f, py);
+        nvgLineTo(_nvg, left + (float)(b + 1) * bandWidth - 1.f, py);
+    }
+    nvgStrokeWidth(_nvg, 1.5f);
+    nvgStrokeColor(_nvg, ALMOST_WHITE);
+    nvgStroke(_nvg);
+}
+
+void UI::Draw() {
+    TRACE_ZONE("UI::Draw");
+    ClearBackground(BG_GREY);
+    _scope.Update(&_synth->tap);
+    {
+        TRACE_ZONE("Spectrum::Update");
+        _spectrum.Update(_scope, SDL_GetTicks());
     }
 
     nvgBeginFrame(_nvg, WINDOW_WIDTH, WINDOW_HEIGHT, 1.f);
+    PatchSelector(100.f, 40.f);
     Oscillator("OSC A", 100.f, 100.f);
-    nvgEndFrame(_nvg);
+    BankOscillator("OSC B", 610.f, 304.f, 1);
+    BankOscillator("OSC C", 890.f, 304.f, 2);
+    ModPanel("MOD", 100.f, 420.f);
+    EffectsPanel("FX", 740.f, 420.f);
+    SpectrumAnalyzer(610.f, 100.f);
+    DspMeter(WINDOW_WIDTH - 100.f - DSP_METER_WIDTH, 100.f);
+    {
+        TRACE_ZONE("nvgEndFrame");
+        nvgEndFrame(_nvg);
+    }
 }
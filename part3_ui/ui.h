@@ -1,5 +1,11 @@
 #pragma once
 
+#include "oscillator.h"
+#include "modmatrix.h"
+#include "effects.h"
+#include "event.h"
+#include "scope.h"
+#include "spectrum.h"
 #include <SDL.h>
 #include <nanovg.h>
 #include <stdint.h>
@@ -47,15 +53,27 @@ private:
             float defaultLev, // level to use on double-click, default level, relative to zero
             float* level, // current level of knob, relative to zero, range [-zero, 1-zero]
             const char* valuetext);
+    void EnvelopeTimeKnob(const char* text, float x, float y, float defaultMs, Event::Param param, float* ms);
     void Oscillator(const char* name, float x, float y);
+    void BankOscillator(const char* name, float x, float y, uint8_t oscillator);
+    void ModPanel(const char* name, float x, float y);
+    void EffectsPanel(const char* name, float x, float y);
+    void DspMeter(float x, float y);
+    void PatchSelector(float x, float y);
+    void SpectrumAnalyzer(float x, float y);
 
     // Utility functions
     bool MouseInRect(float x1, float y1, float x2, float y2);
     bool MouseInCircle(float x, float y, float radius);
     void UpdateOscillatorVisualization();
+    void UpdateKnobLevels(); // of the stepped knobs, after settings change under them
+    void LoadPatch(uint32_t index);
     bool ActiveExists();
     bool IsActive(size_t id);
     bool IsPreactive(size_t id);
+    void SendEvent(const Event& event);
+    void SendParam(Event::Param param, float oldValue, float newValue, uint8_t oscillator = 0);
+    void SendEffect(Event::Effect effect, float oldValue, float newValue);
 
     Synth* _synth = nullptr; // parent object
     Input* _input = nullptr;
@@ -67,7 +85,36 @@ private:
     size_t _preactiveId = 0; // ID of widget about to be active (e.g. hovering)
     size_t _activeId = 0; // ID of widget that is active, being interacted with (e.g. mouse click)
 
-    // Cached visualization of selected oscillator
+    // UI copy of the oscillator settings. Changes are sent to the audio
+    // thread as events.
+    OscillatorParams _oscParams;
+    float _filterKnobLevel = 0.f; // steps through filter types
+    float _unisonKnobLevel = 0.f; // steps through 1 to MAX_UNISON copies
+    std::array<float, NUM_OSCILLATORS> _waveKnobLevels = {}; // steps through sources, OSC B and C
+
+    // UI copy of the modulation settings, published to the audio thread
+    // whenever they change. Knob levels for the ones that step through
+    // choices.
+    mod::Settings _modSettings;
+    std::array<float, mod::NUM_LFOS> _lfoShapeKnobLevels = {};
+    std::array<float, mod::Settings::MAX_ROUTES> _routeSourceKnobLevels = {};
+    std::array<float, mod::Settings::MAX_ROUTES> _routeDestKnobLevels = {};
+
+    // UI copy of the effect settings, sent as events like the oscillator's
+    DelayParams _delayParams;
+    ReverbParams _reverbParams;
+    float _delaySyncKnobLevel = 0.f;
+
+    uint32_t _patchIndex = 0; // factory patch last loaded, edits since aren't saved
+
+    // Cached visualization of selected oscillator, shown while silent
     std::array<float, 256> _oscPoints = {};
+
+    // Live output, min/max per column of the waveform panel
+    static constexpr size_t SCOPE_COLUMNS = 128;
+    Scope _scope;
+    std::array<float, SCOPE_COLUMNS> _scopeMins = {};
+    std::array<float, SCOPE_COLUMNS> _scopeMaxs = {};
+    Spectrum _spectrum;
 };
 
@@ -1,4 +1,5 @@
 #include "utility.h"
+#include <math.h>
 #include <algorithm>
 
 namespace utility {
@@ -12,4 +13,25 @@ float Clamp(float value, float minValue, float maxValue) {
     return std::min(std::max(minValue, value), maxValue);
 }
 
+// Zeroth-order modified Bessel function
+static double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-12 * sum) {
+            break;
+        }
+    }
+    return sum;
+}
+
+double Kaiser(double x, double beta) {
+    if (fabs(x) >= 1.0) {
+        return 0.0;
+    }
+    return BesselI0(beta * sqrt(1.0 - x * x)) / BesselI0(beta);
+}
+
 } // namespace utility
@@ -8,4 +8,7 @@ float Map(float value, float start1, float end1, float start2, float end2);
 // Clamp a value between minValue and maxValue
 float Clamp(float value, float minValue, float maxValue);
 
+// Kaiser window at x in [-1, 1] (0 outside), for FIR filter design
+double Kaiser(double x, double beta);
+
 } // namespace utility
@@ -0,0 +1,172 @@
+#include "voice.h"
+
+VoicePool::VoicePool() {
+    _voiceForNote.fill(NO_VOICE);
+    for (uint8_t i = 0; i < MAX_VOICES; i++) {
+        _voices[i].index = i;
+    }
+    for (uint8_t i = 0; i < MAX_VOICES; i++) {
+        // Pop order is voice 0 first
+        _free[i] = (uint8_t)(MAX_VOICES - 1 - i);
+    }
+    _numFree = MAX_VOICES;
+}
+
+Voice* VoicePool::NoteOn(uint8_t note, float velocity) {
+    if (note >= NUM_KEYS) {
+        return nullptr;
+    }
+
+    // Retrigger if the note is held. Phase and filter carry on, and the
+    // attack starts from the current level, so there's no click.
+    uint8_t voiceIndex = _voiceForNote[note];
+    if (voiceIndex != NO_VOICE) {
+        Voice& voice = _voices[voiceIndex];
+        if (voice.stealing) {
+            // Still fading out the old note, this one hasn't started yet
+            voice.nextVelocity = velocity;
+            return &voice;
+        }
+        voice.startOrder = _nextStartOrder++;
+        voice.velocity = velocity;
+        voice.env.Trigger();
+        voice.sampleStarted = false; // samples play again from the top
+        return &voice;
+    }
+
+    if (_numFree == 0) {
+        // Only happens when the pool is full
+        voiceIndex = FindVictim();
+        if (voiceIndex == NO_VOICE) {
+            return nullptr;
+        }
+        Voice& voice = _voices[voiceIndex];
+        if (_voiceForNote[voice.note] == voiceIndex) {
+            _voiceForNote[voice.note] = NO_VOICE;
+        }
+        _voiceForNote[note] = voiceIndex;
+        voice.stealing = true;
+        voice.nextNote = note;
+        voice.nextVelocity = velocity;
+        voice.stealFrames = STEAL_FADE_FRAMES;
+        return &voice;
+    }
+
+    voiceIndex = _free[--_numFree];
+    _activeSlot[voiceIndex] = (uint8_t)_numActive;
+    _active[_numActive++] = voiceIndex;
+    _voiceForNote[note] = voiceIndex;
+
+    Voice& voice = _voices[voiceIndex];
+    Start(voice, note, velocity);
+    return &voice;
+}
+
+void VoicePool::Start(Voice& voice, uint8_t note, float velocity) {
+    voice.note = note;
+    voice.velocity = velocity;
+    voice.startOrder = _nextStartOrder++;
+    voice.phases = {};
+    for (uint32_t o = 0; o < NUM_OSCILLATORS; o++) {
+        for (uint32_t c = 0; c < MAX_UNISON; c++) {
+            // Spread out, so copies don't start in phase and sweep through
+            // a comb filter. Still repeatable.
+            voice.unisonPhases[o][c] = c * 0x9e3779b9u + voice.startOrder * 0x6d2b79f5u + o * 0x5bd1e995u;
+        }
+    }
+    voice.noise.Seed(voice.startOrder + 1); // repeatable renders
+    voice.filter = {};
+    voice.filterRight = {};
+    voice.env.Reset();
+    voice.env.Trigger();
+    voice.modGain = 1.f;
+    voice.sampleStarted = false;
+}
+
+void VoicePool::NoteOff(uint8_t note) {
+    if (note >= NUM_KEYS) {
+        return;
+    }
+    uint8_t voiceIndex = _voiceForNote[note];
+    if (voiceIndex != NO_VOICE) {
+        _voices[voiceIndex].env.Release();
+        _voiceForNote[note] = NO_VOICE;
+    }
+}
+
+void VoicePool::AllNotesOff() {
+    while (_numActive > 0) {
+        Free(_active[_numActive - 1]);
+    }
+}
+
+void VoicePool::FreeIdle() {
+    // Backwards, so swap-removal only moves voices already checked
+    for (size_t i = _numActive; i-- > 0;) {
+        uint8_t voiceIndex = _active[i];
+        Voice& voice = _voices[voiceIndex];
+        if (voice.stealing) {
+            if (voice.stealFrames == 0) {
+                voice.stealing = false;
+                Start(voice, voice.nextNote, voice.nextVelocity);
+                if (_voiceForNote[voice.note] != voiceIndex) {
+                    // Let go of during the fade
+                    voice.env.Release();
+                }
+            }
+        } else if (voice.env.IsIdle()) {
+            Free(voiceIndex);
+        }
+    }
+}
+
+// Releasing voices go first, quietest first, since they're on their way
+// out anyway. Then the oldest held voice. Voices already being stolen are
+// skipped, NO_VOICE if that's all of them.
+uint8_t VoicePool::FindVictim() const {
+    uint8_t victim = NO_VOICE;
+    for (size_t i = 0; i < _numActive; i++) {
+        const Voice& a = _voices[_active[i]];
+        if (a.stealing) {
+            continue;
+        }
+        if (victim == NO_VOICE) {
+            victim = _active[i];
+            continue;
+        }
+        const Voice& b = _voices[victim];
+        bool aReleasing = (a.env.GetStage() == Envelope::Stage::Release);
+        bool bReleasing = (b.env.GetStage() == Envelope::Stage::Release);
+        bool better = false;
+        if (aReleasing != bReleasing) {
+            better = aReleasing;
+        } else if (aReleasing) {
+            better = (a.env.Level() < b.env.Level());
+        } else {
+            better = (a.startOrder < b.startOrder);
+        }
+        if (better) {
+            victim = _active[i];
+        }
+    }
+    return victim;
+}
+
+void VoicePool::Free(uint8_t voiceIndex) {
+    // Swap-remove from the active list
+    uint8_t slot = _activeSlot[voiceIndex];
+    uint8_t last = _active[--_numActive];
+    _active[slot] = last;
+    _activeSlot[last] = slot;
+
+    Voice& voice = _voices[voiceIndex];
+    if (_voiceForNote[voice.note] == voiceIndex) {
+        _voiceForNote[voice.note] = NO_VOICE;
+    }
+    if (voice.stealing && _voiceForNote[voice.nextNote] == voiceIndex) {
+        _voiceForNote[voice.nextNote] = NO_VOICE;
+    }
+    voice.env.Reset();
+    voice.stealing = false;
+    _free[_numFree++] = voiceIndex;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "constants.h"
+#include "kernels.h"
+#include "filter.h"
+#include "envelope.h"
+#include <array>
+
+struct Voice {
+    uint8_t index = 0; // in the pool, fixed
+    uint8_t note = 0; // 0-based index on 88-key piano
+    float velocity = 1.f; // range [0, 1]
+    uint32_t startOrder = 0; // increases with each note on, used for stealing
+    std::array<uint32_t, NUM_OSCILLATORS> phases = {}; // fraction of a cycle, wraps at 2^32
+    kernels::NoiseState noise; // per voice, so voices can render on any thread
+    filter::State filter;
+    Envelope env; // amplitude
+    float modGain = 1.f; // per-voice volume modulation, at the end of the last block
+
+    // Sampler playback, see Sampler::Render()
+    bool sampleStarted = false; // cleared on note on, the sampler starts the note
+    uint16_t sampleZone = 0;
+    uint64_t samplePosition = 0; // fixed point frames into the zone's sample
+
+    // Voice stealing, see VoicePool::NoteOn(). The old note fades out, then
+    // the voice starts the next one.
+    bool stealing = false;
+    uint8_t nextNote = 0;
+    uint16_t stealFrames = 0; // left of the fade
+    float nextVelocity = 0.f;
+
+    // Unison state last, it's only touched when unison is on and would
+    // otherwise push the mono state above out of the first cache lines
+    std::array<std::array<uint32_t, MAX_UNISON>, NUM_OSCILLATORS> unisonPhases = {}; // per copy
+    filter::State filterRight; // unison renders in stereo
+};
+
+// Fixed-capacity pool of voices. All storage is allocated up front, so
+// nothing here allocates and it is safe to use from the audio thread.
+// A voice stays active through its release, until its envelope goes idle
+// and FreeIdle() hands it back.
+class VoicePool {
+public:
+    VoicePool();
+
+    // Start a note, or retrigger it if it's held. Steals a voice if the
+    // pool is full, the quietest releasing one if there is any, otherwise
+    // the oldest. A stolen voice fades out over STEAL_FADE_FRAMES first and
+    // starts the note in FreeIdle() after that, cutting it off would click.
+    // Returns nullptr if the note was dropped, when every voice is already
+    // being stolen.
+    Voice* NoteOn(uint8_t note, float velocity = 1.f);
+
+    // Release the note's envelope, it keeps sounding until it fades out
+    void NoteOff(uint8_t note);
+
+    // Stop every voice immediately
+    void AllNotesOff();
+
+    // Free voices whose envelope has finished, so they're no longer
+    // rendered, and start the next note on stolen voices that have faded
+    // out. Call after each block.
+    void FreeIdle();
+
+    static constexpr uint16_t STEAL_FADE_FRAMES = BLOCK_FRAMES;
+
+    size_t NumActive() const { return _numActive; }
+    Voice& Active(size_t i) { return _voices[_active[i]]; }
+
+private:
+    static constexpr uint8_t NO_VOICE = 0xFF;
+
+    void Start(Voice& voice, uint8_t note, float velocity);
+    void Free(uint8_t voiceIndex);
+    uint8_t FindVictim() const;
+
+    std::array<Voice, MAX_VOICES> _voices = {};
+
+    // Indices of sounding voices, unordered
+    std::array<uint8_t, MAX_VOICES> _active = {};
+    size_t _numActive = 0;
+
+    // Position of each sounding voice within _active, for O(1) removal
+    std::array<uint8_t, MAX_VOICES> _activeSlot = {};
+
+    // Stack of idle voice indices
+    std::array<uint8_t, MAX_VOICES> _free = {};
+    size_t _numFree = 0;
+
+    // Voice holding each note down, or NO_VOICE. Released voices aren't
+    // in here.
+    std::array<uint8_t, NUM_KEYS> _voiceForNote = {};
+
+    uint32_t _nextStartOrder = 0;
+};
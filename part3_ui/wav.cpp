@@ -0,0 +1,157 @@
+#include "wav.h"
+#include <SDL.h>
+#include <string.h>
+#include <algorithm>
+
+static constexpr uint16_t FORMAT_PCM = 1;
+static constexpr uint16_t FORMAT_IEEE_FLOAT = 3;
+static constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE; // real format in the first 2 bytes of the subformat GUID
+static constexpr uint32_t HEADER_BYTES = 44;
+
+static void PutU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void PutU32(uint8_t* p, uint32_t v) {
+    PutU16(p, (uint16_t)(v & 0xFFFF));
+    PutU16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t GetU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t* p) {
+    return (uint32_t)GetU16(p) | ((uint32_t)GetU16(p + 2) << 16);
+}
+
+WavWriter::~WavWriter() {
+    Close();
+}
+
+bool WavWriter::Open(const char* path, uint32_t sampleRateHz, uint16_t channels) {
+    _file = fopen(path, "wb");
+    if (_file == nullptr) {
+        SDL_Log("Could not open %s for writing", path);
+        return false;
+    }
+    _channels = channels;
+    _dataBytes = 0;
+
+    // Sizes are patched in Close()
+    uint16_t blockAlign = (uint16_t)(channels * sizeof(float));
+    uint8_t header[HEADER_BYTES] = {};
+    memcpy(header, "RIFF", 4);
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    PutU32(header + 16, 16);
+    PutU16(header + 20, FORMAT_IEEE_FLOAT);
+    PutU16(header + 22, channels);
+    PutU32(header + 24, sampleRateHz);
+    PutU32(header + 28, sampleRateHz * blockAlign);
+    PutU16(header + 32, blockAlign);
+    PutU16(header + 34, 8 * sizeof(float));
+    memcpy(header + 36, "data", 4);
+    return (fwrite(header, 1, sizeof(header), _file) == sizeof(header));
+}
+
+bool WavWriter::Write(const float* samples, size_t frames) {
+    // Host is assumed little-endian, same as the .wav format
+    size_t count = frames * _channels;
+    if (fwrite(samples, sizeof(float), count, _file) != count) {
+        return false;
+    }
+    _dataBytes += (uint32_t)(count * sizeof(float));
+    return true;
+}
+
+bool WavWriter::Close() {
+    if (_file == nullptr) {
+        return true;
+    }
+    uint8_t size[4];
+    bool ok = true;
+    PutU32(size, HEADER_BYTES - 8 + _dataBytes);
+    ok &= (fseek(_file, 4, SEEK_SET) == 0 && fwrite(size, 1, 4, _file) == 4);
+    PutU32(size, _dataBytes);
+    ok &= (fseek(_file, 40, SEEK_SET) == 0 && fwrite(size, 1, 4, _file) == 4);
+    ok &= (fclose(_file) == 0);
+    _file = nullptr;
+    return ok;
+}
+
+//-----------------------
+// Reading
+//-----------------------
+
+bool ParseWavHeader(const uint8_t* bytes, size_t size, WavFormat* format) {
+    if (size < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        SDL_Log("Not a .wav file");
+        return false;
+    }
+
+    // Chunks are word aligned, skip any we don't need
+    bool haveFormat = false;
+    uint16_t tag = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = bytes + pos;
+        size_t chunkBytes = GetU32(chunk + 4);
+        size_t body = pos + 8;
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunkBytes >= 16 && body + chunkBytes <= size) {
+            tag = GetU16(bytes + body);
+            format->channels = GetU16(bytes + body + 2);
+            format->sampleRateHz = GetU32(bytes + body + 4);
+            format->bitsPerSample = GetU16(bytes + body + 14);
+            if (tag == FORMAT_EXTENSIBLE && chunkBytes >= 26) {
+                tag = GetU16(bytes + body + 24);
+            }
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                break;
+            }
+            format->isFloat = (tag == FORMAT_IEEE_FLOAT);
+            bool supported = (tag == FORMAT_PCM && (format->bitsPerSample == 16 || format->bitsPerSample == 24 || format->bitsPerSample == 32))
+                    || (tag == FORMAT_IEEE_FLOAT && format->bitsPerSample == 32);
+            if (!supported || format->channels == 0 || format->sampleRateHz == 0) {
+                SDL_Log("Unsupported .wav format %u, %u bits, %u channels", tag, format->bitsPerSample, format->channels);
+                return false;
+            }
+            // Writers that stream often leave the size unpatched
+            format->dataOffset = body;
+            format->frames = std::min(chunkBytes, size - body) / format->BytesPerFrame();
+            return true;
+        }
+        pos = body + chunkBytes + (chunkBytes & 1);
+    }
+    SDL_Log("No %s chunk in .wav file", haveFormat ? "data" : "fmt");
+    return false;
+}
+
+void DecodeWavMono(const WavFormat& format, const uint8_t* bytes, size_t first, size_t count, float* out) {
+    // Host is assumed little-endian, same as the .wav format
+    size_t bytesPerSample = format.bitsPerSample / 8;
+    const uint8_t* p = bytes + format.dataOffset + first * format.BytesPerFrame();
+    float scale = 1.f / (float)format.channels;
+    for (size_t i = 0; i < count; i++) {
+        float sum = 0.f;
+        for (uint16_t c = 0; c < format.channels; c++) {
+            if (format.isFloat) {
+                float value;
+                memcpy(&value, p, sizeof(value));
+                sum += value;
+            } else if (bytesPerSample == 2) {
+                sum += (float)(int16_t)GetU16(p) * (1.f / 32768.f);
+            } else if (bytesPerSample == 3) {
+                int32_t value = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+                sum += (float)value * (1.f / 8388608.f);
+            } else {
+                sum += (float)(int32_t)GetU32(p) * (1.f / 2147483648.f);
+            }
+            p += bytesPerSample;
+        }
+        out[i] = sum * scale;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Streams 32-bit float PCM to a .wav file
+class WavWriter {
+public:
+    ~WavWriter();
+
+    bool Open(const char* path, uint32_t sampleRateHz, uint16_t channels);
+
+    // Append interleaved frames
+    bool Write(const float* samples, size_t frames);
+
+    // Patch the header sizes and close the file
+    bool Close();
+
+private:
+    FILE* _file = nullptr;
+    uint16_t _channels = 0;
+    uint32_t _dataBytes = 0;
+};
+
+// Layout of the samples in a .wav file, from its header
+struct WavFormat {
+    uint16_t channels = 0;
+    uint16_t bitsPerSample = 0; // 16, 24 or 32
+    bool isFloat = false; // 32-bit IEEE float, otherwise integer PCM
+    uint32_t sampleRateHz = 0;
+    size_t dataOffset = 0; // bytes from the start of the file
+    size_t frames = 0;
+
+    size_t BytesPerFrame() const { return (size_t)channels * bitsPerSample / 8; }
+};
+
+// Parse the header of a .wav file held in memory (usually mapped). False,
+// with a log message, if it's malformed or a format DecodeWavMono() can't
+// read.
+bool ParseWavHeader(const uint8_t* bytes, size_t size, WavFormat* format);
+
+// Convert frames [first, first + count) of a parsed file to float, with
+// the channels averaged down to mono
+void DecodeWavMono(const WavFormat& format, const uint8_t* bytes, size_t first, size_t count, float* out);
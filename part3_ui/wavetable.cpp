@@ -0,0 +1,152 @@
+#include "wavetable.h"
+#include <math.h>
+#include <algorithm>
+
+static constexpr uint32_t FRAC_BITS = 32 - Wavetable::TABLE_BITS;
+static constexpr uint32_t FRAC_MASK = (1u << FRAC_BITS) - 1;
+static constexpr float FRAC_SCALE = 1.f / (float)(1u << FRAC_BITS);
+
+void Wavetable::Build(float (*fn)(float phase), float sampleRateHz) {
+    _sampleRateHz = sampleRateHz;
+    constexpr uint32_t N = TABLE_SIZE;
+    constexpr uint32_t MAX_HARMONIC = N / 2 - 1;
+
+    // One cycle of the (aliased) waveform, and a twiddle table
+    std::vector<double> samples(N);
+    std::vector<double> cosTable(N);
+    std::vector<double> sinTable(N);
+    for (uint32_t n = 0; n < N; n++) {
+        double phase = 2.0 * M_PI * n / N;
+        samples[n] = fn((float)phase);
+        cosTable[n] = cos(phase);
+        sinTable[n] = sin(phase);
+    }
+
+    // Fourier series coefficients via a plain DFT. Only runs at startup.
+    std::vector<double> a(MAX_HARMONIC + 1);
+    std::vector<double> b(MAX_HARMONIC + 1);
+    for (uint32_t k = 1; k <= MAX_HARMONIC; k++) {
+        double sumCos = 0.0;
+        double sumSin = 0.0;
+        for (uint32_t n = 0; n < N; n++) {
+            uint32_t t = (k * n) & (N - 1);
+            sumCos += samples[n] * cosTable[t];
+            sumSin += samples[n] * sinTable[t];
+        }
+        a[k] = 2.0 * sumCos / N;
+        b[k] = 2.0 * sumSin / N;
+    }
+
+    // Resynthesize each level with only the harmonics that fit below Nyquist
+    _tables.assign(NUM_LEVELS * STRIDE, 0.f);
+    std::vector<double> level(N);
+    for (uint32_t m = 0; m < NUM_LEVELS; m++) {
+        float maxFreq = LEVEL0_MAX_FREQ * (float)(1u << m);
+        uint32_t harmonics = (uint32_t)(sampleRateHz / 2.f / maxFreq);
+        harmonics = std::clamp(harmonics, 1u, MAX_HARMONIC);
+
+        std::fill(level.begin(), level.end(), 0.0);
+        for (uint32_t k = 1; k <= harmonics; k++) {
+            for (uint32_t n = 0; n < N; n++) {
+                uint32_t t = (k * n) & (N - 1);
+                level[n] += a[k] * cosTable[t] + b[k] * sinTable[t];
+            }
+        }
+
+        float* table = &_tables[m * STRIDE + GUARD_BEFORE];
+        for (uint32_t n = 0; n < N; n++) {
+            table[n] = (float)level[n];
+        }
+        table[-1] = table[N - 1];
+        table[N] = table[0];
+        table[N + 1] = table[1];
+    }
+}
+
+uint32_t Wavetable::LevelForFrequency(float freqHz) {
+    // Number of octaves above LEVEL0_MAX_FREQ, rounded up
+    uint32_t ratio = (uint32_t)std::max(freqHz / LEVEL0_MAX_FREQ, 0.f);
+    uint32_t level = 0;
+    while (ratio > 0 && level < NUM_LEVELS - 1) {
+        ratio >>= 1;
+        level++;
+    }
+    return level;
+}
+
+uint32_t Wavetable::PhaseIncrement(float freqHz) const {
+    double cyclesPerSample = std::clamp((double)freqHz / _sampleRateHz, 0.0, 0.5);
+    return (uint32_t)(cyclesPerSample * 4294967296.0);
+}
+
+// With ADD, out gets gain times the waveform added to it, so several
+// oscillators can share one buffer
+template <Wavetable::Interpolation I, bool ADD>
+void Wavetable::RenderLevel(
+        const float* table, float* out, size_t frames, uint32_t* phase, uint32_t increment, float gain) const {
+    uint32_t p = *phase;
+    for (size_t i = 0; i < frames; i++) {
+        uint32_t index = p >> FRAC_BITS;
+        float frac = (float)(p & FRAC_MASK) * FRAC_SCALE;
+        const float* y = &table[index];
+        float value;
+        if constexpr (I == Interpolation::Cubic) {
+            // 4-point, 3rd-order Hermite
+            float c1 = 0.5f * (y[1] - y[-1]);
+            float c2 = y[-1] - 2.5f * y[0] + 2.f * y[1] - 0.5f * y[2];
+            float c3 = 0.5f * (y[2] - y[-1]) + 1.5f * (y[0] - y[1]);
+            value = ((c3 * frac + c2) * frac + c1) * frac + y[0];
+        } else {
+            value = y[0] + frac * (y[1] - y[0]);
+        }
+        if constexpr (ADD) {
+            out[i] += gain * value;
+        } else {
+            out[i] = value;
+        }
+        p += increment;
+    }
+    *phase = p;
+}
+
+void Wavetable::Render(
+        uint32_t level,
+        Interpolation interpolation,
+        float* out,
+        size_t frames,
+        uint32_t* phase,
+        uint32_t increment) const {
+    const float* table = Level(std::min(level, NUM_LEVELS - 1));
+    if (interpolation == Interpolation::Cubic) {
+        RenderLevel<Interpolation::Cubic, false>(table, out, frames, phase, increment, 1.f);
+    } else {
+        RenderLevel<Interpolation::Linear, false>(table, out, frames, phase, increment, 1.f);
+    }
+}
+
+void Wavetable::RenderAdd(
+        uint32_t level,
+        Interpolation interpolation,
+        float* out,
+        size_t frames,
+        uint32_t* phase,
+        uint32_t increment,
+        float gain) const {
+    const float* table = Level(std::min(level, NUM_LEVELS - 1));
+    if (interpolation == Interpolation::Cubic) {
+        RenderLevel<Interpolation::Cubic, true>(table, out, frames, phase, increment, gain);
+    } else {
+        RenderLevel<Interpolation::Linear, true>(table, out, frames, phase, increment, gain);
+    }
+}
+
+void Wavetable::RenderUnison(
+        uint32_t level,
+        Interpolation interpolation,
+        kernels::UnisonLanes* lanes,
+        float* left,
+        float* right,
+        size_t frames) const {
+    const float* table = Level(std::min(level, NUM_LEVELS - 1));
+    kernels::Unison(lanes, table, TABLE_BITS, interpolation == Interpolation::Cubic, left, right, frames);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "constants.h"
+#include "kernels.h"
+#include <stddef.h>
+#include <vector>
+
+// Band-limited wavetable for one periodic waveform, with one table per
+// octave (mip level). Each level only contains harmonics that stay below
+// Nyquist for every frequency that plays from it, so playback does not
+// alias.
+class Wavetable {
+public:
+    enum class Interpolation {
+        Linear,
+        Cubic,
+    };
+
+    static constexpr uint32_t TABLE_BITS = 11;
+    static constexpr uint32_t TABLE_SIZE = (1 << TABLE_BITS);
+    static constexpr uint32_t NUM_LEVELS = 11;
+
+    // Build all mip levels from a waveform function, where phase is in
+    // radians, [0, TWOPI), for playback at sampleRateHz. Slow, only call
+    // at startup.
+    void Build(float (*fn)(float phase), float sampleRateHz);
+
+    // Mip level to use for playing a given frequency
+    static uint32_t LevelForFrequency(float freqHz);
+
+    // Phase increment per sample for the 32-bit phase accumulator
+    uint32_t PhaseIncrement(float freqHz) const;
+
+    // Fill out[0..frames) from the given mip level, advancing phase by
+    // increment per sample. phase wraps naturally at 2^32.
+    void Render(
+            uint32_t level,
+            Interpolation interpolation,
+            float* out,
+            size_t frames,
+            uint32_t* phase,
+            uint32_t increment) const;
+
+    // The same, adding gain times the waveform to out instead
+    void RenderAdd(
+            uint32_t level,
+            Interpolation interpolation,
+            float* out,
+            size_t frames,
+            uint32_t* phase,
+            uint32_t increment,
+            float gain) const;
+
+    // Add up to kernels::UNISON_LANES copies, each with its own phase and
+    // increment, to a stereo pair. Interpolated the same as Render().
+    void RenderUnison(
+            uint32_t level,
+            Interpolation interpolation,
+            kernels::UnisonLanes* lanes,
+            float* left,
+            float* right,
+            size_t frames) const;
+
+private:
+    // Highest fundamental (Hz) played from level 0. Doubles with each level.
+    static constexpr float LEVEL0_MAX_FREQ = 40.f;
+
+    // Each level has 1 guard sample before and 2 after the table, so cubic
+    // interpolation never has to wrap its index
+    static constexpr uint32_t GUARD_BEFORE = 1;
+    static constexpr uint32_t STRIDE = TABLE_SIZE + 3;
+
+    const float* Level(uint32_t level) const {
+        return &_tables[level * STRIDE + GUARD_BEFORE];
+    }
+
+    template <Interpolation I, bool ADD>
+    void RenderLevel(const float* table, float* out, size_t frames, uint32_t* phase, uint32_t increment, float gain) const;
+
+    std::vector<float> _tables; // NUM_LEVELS * STRIDE
+    float _sampleRateHz = DEFAULT_SAMPLE_RATE_HZ;
+};
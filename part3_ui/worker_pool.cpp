@@ -0,0 +1,157 @@
+#include "worker_pool.h"
+#include "kernels.h"
+#include "trace.h"
+#include <SDL.h>
+#include <assert.h>
+#include <algorithm>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+WorkerPool::~WorkerPool() {
+    if (_threads.empty()) {
+        return;
+    }
+    _stop = true;
+    _generation.fetch_add(1, std::memory_order_release);
+    WakeWorkers();
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+bool WorkerPool::Init(uint32_t numWorkers, uint32_t spinMicros) {
+#ifdef IS_WASM_BUILD
+    // No threads in the browser build, Run() works on the calling thread
+    return true;
+#else
+    if (numWorkers == 0) {
+        uint32_t cores = std::thread::hardware_concurrency();
+        numWorkers = (cores > 1 ? cores - 1 : 0);
+    }
+    numWorkers = std::min(numWorkers, MAX_WORKERS);
+    _spinMicros = spinMicros;
+
+    _threads.reserve(numWorkers);
+    for (uint32_t i = 0; i < numWorkers; i++) {
+        _threads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+#ifdef __linux__
+        // Pin worker i to core i + 1, leaving core 0 for the audio thread
+        // and UI. Not fatal if it fails.
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET((i + 1) % std::max(std::thread::hardware_concurrency(), 1u), &cpus);
+        pthread_setaffinity_np(_threads.back().native_handle(), sizeof(cpus), &cpus);
+#endif
+    }
+    SDL_Log("Started %u audio worker threads", numWorkers);
+    return true;
+#endif
+}
+
+void WorkerPool::Run(TaskFn fn, void* context, size_t numTasks) {
+    if (_threads.empty() || numTasks <= 1) {
+        for (size_t task = 0; task < numTasks; task++) {
+            fn(context, task);
+        }
+        return;
+    }
+
+    // Every task of the last job is done, and workers only read the job
+    // after claiming a task, so nothing reads it while it's written. A
+    // late worker holding the old cursor fails its claim, rereads the
+    // cursor and finds this job.
+    assert(numTasks <= MAX_TASKS);
+    _fn = fn;
+    _context = context;
+    _doneTasks.store(0, std::memory_order_relaxed);
+    uint64_t job = (_cursor.load(std::memory_order_relaxed) >> 32) + 1;
+    _cursor.store((job << 32) | ((uint64_t)numTasks << 16), std::memory_order_release);
+    // Store then load, against the store then load in WaitForWork(). Both
+    // sides need seq_cst, acquire/release would let each miss the other's
+    // store and the worker sleep through this job.
+    _generation.fetch_add(1, std::memory_order_seq_cst);
+    if (_sleepers.load(std::memory_order_seq_cst) > 0) {
+        WakeWorkers();
+    }
+
+    RunTasks();
+
+    // Barrier. Tasks claimed by workers are already running, so this is
+    // at most one task long.
+    while (_doneTasks.load(std::memory_order_acquire) < numTasks) {
+        CpuRelax();
+    }
+}
+
+void WorkerPool::RunTasks() {
+    uint64_t cursor = _cursor.load(std::memory_order_acquire);
+    while (true) {
+        size_t task = cursor & 0xFFFF;
+        size_t numTasks = (cursor >> 16) & 0xFFFF;
+        if (task >= numTasks) {
+            return;
+        }
+        // On failure cursor is reloaded, possibly with a newer job
+        if (_cursor.compare_exchange_weak(cursor, cursor + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            _fn(_context, task);
+            _doneTasks.fetch_add(1, std::memory_order_release);
+            cursor++;
+        }
+    }
+}
+
+void WorkerPool::WorkerLoop(uint32_t index) {
+    TRACE_THREAD("audio worker");
+    kernels::FlushDenormals();
+    uint32_t generation = 0;
+    while (true) {
+        WaitForWork(generation);
+        generation = _generation.load(std::memory_order_acquire);
+        if (_stop) {
+            return;
+        }
+        RunTasks();
+    }
+}
+
+void WorkerPool::WaitForWork(uint32_t lastGeneration) {
+    // Spin first, the next block is usually close
+    auto spinUntil = std::chrono::steady_clock::now() + std::chrono::microseconds(_spinMicros);
+    while (_generation.load(std::memory_order_acquire) == lastGeneration) {
+        if (std::chrono::steady_clock::now() < spinUntil) {
+            for (int i = 0; i < 64; i++) {
+                CpuRelax();
+            }
+            continue;
+        }
+
+        _sleepers.fetch_add(1, std::memory_order_seq_cst); // see Run()
+#ifdef __linux__
+        // Sleeps only if _generation still equals lastGeneration
+        syscall(SYS_futex, (uint32_t*)&_generation, FUTEX_WAIT_PRIVATE, lastGeneration, nullptr, nullptr, 0);
+#else
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+        _sleepers.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void WorkerPool::WakeWorkers() {
+#ifdef __linux__
+    syscall(SYS_futex, (uint32_t*)&_generation, FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
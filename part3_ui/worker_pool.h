@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+// Real-time thread pool for splitting audio work across cores. Threads are
+// created and pinned up front. Run() never allocates or locks: workers
+// claim tasks from a shared atomic cursor, the calling thread works too,
+// and Run() returns once every task is done. Idle workers spin briefly,
+// then sleep on a futex (Linux) until the next Run().
+class WorkerPool {
+public:
+    typedef void (*TaskFn)(void* context, size_t task);
+
+    ~WorkerPool();
+
+    // Start numWorkers threads, or one per core minus one (for the audio
+    // thread) if 0. Workers spin for spinMicros after each Run() before
+    // sleeping. Call once, before the audio thread is running.
+    bool Init(uint32_t numWorkers = 0, uint32_t spinMicros = 250);
+
+    uint32_t NumWorkers() const { return (uint32_t)_threads.size(); }
+
+    // Call fn(context, task) for every task in [0, numTasks), spread over
+    // the workers and the calling thread. Only one thread may call Run().
+    // numTasks <= MAX_TASKS.
+    void Run(TaskFn fn, void* context, size_t numTasks);
+
+    static constexpr size_t MAX_TASKS = 0xFFFF;
+
+private:
+    static constexpr uint32_t MAX_WORKERS = 15;
+
+    void WorkerLoop(uint32_t index);
+    void RunTasks();
+    void WaitForWork(uint32_t lastGeneration);
+    void WakeWorkers();
+
+    std::vector<std::thread> _threads;
+    uint32_t _spinMicros = 0;
+    std::atomic<bool> _stop{false};
+
+    // Current job, published by the release store to _cursor. Only read
+    // after claiming one of its tasks, which keeps Run() from moving on
+    // to the next job until the task is done.
+    TaskFn _fn = nullptr;
+    void* _context = nullptr;
+
+    // Job number (top 32 bits), number of tasks (16) and next task to
+    // claim (16), swapped in whole by Run(). A claim is a CAS on all of
+    // it, so it can only succeed for a task of the job it was read from.
+    alignas(64) std::atomic<uint64_t> _cursor{0};
+    alignas(64) std::atomic<size_t> _doneTasks{0};
+
+    // Bumped for each Run(), workers sleep on it
+    alignas(64) std::atomic<uint32_t> _generation{0};
+    std::atomic<uint32_t> _sleepers{0};
+};